@@ -23,38 +23,17 @@
 #include "ns3/uinteger.h"
 #include "ns3/log.h"
 
-#define Min(a,b) ((a < b) ? a : b)
-#define Max(a,b) ((a > b) ? a : b)
-
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("AarfWifiManager");
 
-/**
- * \brief hold per-remote-station state for AARF Wifi manager.
- *
- * This struct extends from WifiRemoteStation struct to hold additional
- * information required by the AARF Wifi manager
- */
-struct AarfWifiRemoteStation : public WifiRemoteStation
-{
-  uint32_t m_timer; ///< timer
-  uint32_t m_success; ///< success
-  uint32_t m_failed; ///< failed
-  bool m_recovery; ///< recovery
-  uint32_t m_retry; ///< retry
-  uint32_t m_timerTimeout; ///< timer timeout
-  uint32_t m_successThreshold; ///< success threshold
-  uint32_t m_rate; ///< rate
-};
-
 NS_OBJECT_ENSURE_REGISTERED (AarfWifiManager);
 
 TypeId
 AarfWifiManager::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::AarfWifiManager")
-    .SetParent<WifiRemoteStationManager> ()
+    .SetParent<ArfFamilyWifiManager<AarfThresholdPolicy> > ()
     .SetGroupName ("Wifi")
     .AddConstructor<AarfWifiManager> ()
     .AddAttribute ("SuccessK", "Multiplication factor for the success threshold in the AARF algorithm.",
@@ -84,15 +63,15 @@ AarfWifiManager::GetTypeId (void)
     .AddTraceSource ("Rate",
                      "Traced value for rate changes (b/s)",
                      MakeTraceSourceAccessor (&AarfWifiManager::m_currentRate),
-                     "ns3::TracedValueCallback::Uint64")
+                     "ns3::TracedValueCallback::Uint64",
+                     TypeId::DEPRECATED,
+                     "Follows whichever station transmits: use RateChange instead.")
   ;
   return tid;
 }
 
 //Constructor
 AarfWifiManager::AarfWifiManager ()
-  : WifiRemoteStationManager (),
-    m_currentRate (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -103,271 +82,4 @@ AarfWifiManager::~AarfWifiManager ()
   NS_LOG_FUNCTION (this);
 }
 
-/*DoCreateStation is initializing the member variables of class ArfWifiRemoteStation*/
-WifiRemoteStation *
-AarfWifiManager::DoCreateStation (void) const
-{
-  NS_LOG_FUNCTION (this);
-  AarfWifiRemoteStation *station = new AarfWifiRemoteStation ();
-
-  station->m_successThreshold = m_minSuccessThreshold;
-  station->m_timerTimeout = m_minTimerThreshold;
-  station->m_rate = 0;
-  station->m_success = 0;
-  station->m_failed = 0;
-  station->m_recovery = false;
-  station->m_retry = 0;
-  station->m_timer = 0;
-
-  return station;
-}
-
-/*DoReportRtsFailed is called in the event of RTS failure. It isjust an
- informational function which logs the information in case of a RTS 
- failure*/
-void
-AarfWifiManager::DoReportRtsFailed (WifiRemoteStation *station)
-{
-  NS_LOG_FUNCTION (this << station);
-}
-/**
- * It is important to realize that "recovery" mode starts after failure of
- * the first transmission after a rate increase and ends at the first successful
- * transmission. Specifically, recovery mode transcends retransmissions boundaries.
- * Fundamentally, ARF handles each data transmission independently, whether it
- * is the initial transmission of a packet or the retransmission of a packet.
- * The fundamental reason for this is that there is a backoff between each data
- * transmission, be it an initial transmission or a retransmission.
- *
- * \param st the station that we failed to send DATA
- */
-
-/*DoReportDataFailed is called in the even of data transmission sucess.
-First it updates transmission statistics variables like m_failed, m_success, etc.
-If Recovery mode is enabled (or member variable m_recovery is true) then
-it checks if number of retries are greater than 1, then it decrements data rate
-to lower available data rate, if it exists and doubles the success threshold. If not
-in recovery mode, it does  normal fallback, i.e. only on 2 consecutive data packet 
-failures, it will decrement data rate to a lower available data rate, if it exists. */
-void
-AarfWifiManager::DoReportDataFailed (WifiRemoteStation *st)
-{
-  NS_LOG_FUNCTION (this << st);
-  AarfWifiRemoteStation *station = (AarfWifiRemoteStation *)st;
-  station->m_timer++;
-  station->m_failed++;
-  station->m_retry++;
-  station->m_success = 0;
-
-  if (station->m_recovery)
-    {
-      NS_ASSERT (station->m_retry >= 1);
-      if (station->m_retry == 1)
-        {
-          //need recovery fallback
-          station->m_successThreshold = (int)(Min (station->m_successThreshold * m_successK,
-                                                   m_maxSuccessThreshold));
-          station->m_timerTimeout = (int)(Max (station->m_timerTimeout * m_timerK,
-                                               m_minSuccessThreshold));
-          if (station->m_rate != 0)
-            {
-              station->m_rate--;
-            }
-        }
-      station->m_timer = 0;
-    }
-  else
-    {
-      NS_ASSERT (station->m_retry >= 1);
-      if (((station->m_retry - 1) % 2) == 1)
-        {
-          //need normal fallback
-          station->m_timerTimeout = m_minTimerThreshold;
-          station->m_successThreshold = m_minSuccessThreshold;
-          if (station->m_rate != 0)
-            {
-              station->m_rate--;
-            }
-        }
-      if (station->m_retry >= 2)
-        {
-          station->m_timer = 0;
-        }
-    }
-}
-
-/* DoReportRxOk function is called in the event of a successful data packet
-reception at the receiving station. This function is also an informational 
-function that logs the remote station name, related SNR  and its transmission mode.
-*/
-void
-AarfWifiManager::DoReportRxOk (WifiRemoteStation *station,
-                               double rxSnr, WifiMode txMode)
-{
-  NS_LOG_FUNCTION (this << station << rxSnr << txMode);
-}
-
-/* DoReportRtsOk function is called in the event of a successful Rts packet
-reception. This function is also an information function that logs the
-remote station name, SNR of cts packet, cts transmission mode and SNR of
-rts packet.
-*/
-void
-AarfWifiManager::DoReportRtsOk (WifiRemoteStation *station,
-                                double ctsSnr, WifiMode ctsMode, double rtsSnr)
-{
-  NS_LOG_FUNCTION (this << station << ctsSnr << ctsMode << rtsSnr);
-  NS_LOG_DEBUG ("station=" << station << " rts ok");
-}
-
-/*DoReportDataOk function is  called in the event of a successful ACK packet
-reception at sender side. First it updates tansmission statistics like m_failed,
-m_success, etc. If number of successful packets tranmitted equals N, or timer
-value reaches N, then rate is incremented to a higher available rate, if it exists
-and recovery mode is turned on. If switched to a new rate, reset member variables 
-m_success and m_timer so that they can contain statistics of new data rate
-*/
-void
-AarfWifiManager::DoReportDataOk (WifiRemoteStation *st,
-                                 double ackSnr, WifiMode ackMode, double dataSnr)
-{
-  NS_LOG_FUNCTION (this << st << ackSnr << ackMode << dataSnr);
-  AarfWifiRemoteStation *station = (AarfWifiRemoteStation *) st;
-  station->m_timer++;
-  station->m_success++;
-  station->m_failed = 0;
-  station->m_recovery = false;
-  station->m_retry = 0;
-  NS_LOG_DEBUG ("station=" << station << " data ok success=" << station->m_success << ", timer=" << station->m_timer);
-  if ((station->m_success == station->m_successThreshold
-       || station->m_timer == station->m_timerTimeout)
-      && (station->m_rate < (GetNSupported (station) - 1)))
-    {
-      NS_LOG_DEBUG ("station=" << station << " inc rate");
-      station->m_rate++;
-      station->m_timer = 0;
-      station->m_success = 0;
-      station->m_recovery = true;
-    }
-}
-
-/*DoReportFinalRtsFailed function is called in the event when the transmission 
-of a RTS has exceeded the maximum number of attempts
-*/
-void
-AarfWifiManager::DoReportFinalRtsFailed (WifiRemoteStation *station)
-{
-  NS_LOG_FUNCTION (this << station);
-}
-
-/*DoReportFinalDataFailed unction is called in the event when the  transmission
- of a data packet has exceeded the maximum number of attempts
-*/
-void
-AarfWifiManager::DoReportFinalDataFailed (WifiRemoteStation *station)
-{
-  NS_LOG_FUNCTION (this << station);
-}
-
-/* This function returns Wifi data transmission vector. Wifi data transmission vector
-contains Wifi mode, default transmission power level, Retry count, Preamble 
-for sending station, 800, 1, 1, 0, physical channel width, GetAggregation (station), false)
-*/
-WifiTxVector
-AarfWifiManager::DoGetDataTxVector (WifiRemoteStation *st)
-{
-  NS_LOG_FUNCTION (this << st);
-  AarfWifiRemoteStation *station = (AarfWifiRemoteStation *) st;
-  uint32_t channelWidth = GetChannelWidth (station);
-  if (channelWidth > 20 && channelWidth != 22)
-    {
-      //avoid to use legacy rate adaptation algorithms for IEEE 802.11n/ac
-      channelWidth = 20;
-    }
-  WifiMode mode = GetSupported (station, station->m_rate);
-  if (m_currentRate != mode.GetDataRate (channelWidth))
-    {
-      NS_LOG_DEBUG ("New datarate: " << mode.GetDataRate (channelWidth));
-      m_currentRate = mode.GetDataRate (channelWidth);
-    }
-  return WifiTxVector (mode, GetDefaultTxPowerLevel (), GetLongRetryCount (station), GetPreambleForTransmission (mode, GetAddress (station)), 800, 1, 1, 0, channelWidth, GetAggregation (station), false);
-}
-
-/*This function returns Wifi Rts transmission vector. Wifi Rts transmission vector
-contains Wifi mode, default transmission power level, Retry count, Preamble 
-for sending station, 800, 1, 1, 0, physical channel width, GetAggregation (station), false)
-*/
-WifiTxVector
-AarfWifiManager::DoGetRtsTxVector (WifiRemoteStation *st)
-{
-  NS_LOG_FUNCTION (this << st);
-  /// \todo we could/should implement the Aarf algorithm for
-  /// RTS only by picking a single rate within the BasicRateSet.
-  AarfWifiRemoteStation *station = (AarfWifiRemoteStation *) st;
-  uint32_t channelWidth = GetChannelWidth (station);
-  if (channelWidth > 20 && channelWidth != 22)
-    {
-      //avoid to use legacy rate adaptation algorithms for IEEE 802.11n/ac
-      channelWidth = 20;
-    }
-  WifiTxVector rtsTxVector;
-  WifiMode mode;
-  if (GetUseNonErpProtection () == false)
-    {
-      mode = GetSupported (station, 0);
-    }
-  else
-    {
-      mode = GetNonErpSupported (station, 0);
-    }
-  rtsTxVector = WifiTxVector (mode, GetDefaultTxPowerLevel (), GetLongRetryCount (station), GetPreambleForTransmission (mode, GetAddress (station)), 800, 1, 1, 0, channelWidth, GetAggregation (station), false);
-  return rtsTxVector;
-}
-
-/*IsLowLatency function returns whether this manager is a manager 
-designed to work in low-latency environments.
-*/
-bool
-AarfWifiManager::IsLowLatency (void) const
-{
-  NS_LOG_FUNCTION (this);
-  return true;
-}
-
-/*This function is called if a wifi standard is being used which uses High Throughput rates.
-*/
-void
-AarfWifiManager::SetHtSupported (bool enable)
-{
-  //HT is not supported by this algorithm.
-  if (enable)
-    {
-      NS_FATAL_ERROR ("WifiRemoteStationManager selected does not support HT rates");
-    }
-}
-
-/*This function is called if a wifi standard is being used which uses Very High Throughput rates.
-*/
-void
-AarfWifiManager::SetVhtSupported (bool enable)
-{
-  //VHT is not supported by this algorithm.
-  if (enable)
-    {
-      NS_FATAL_ERROR ("WifiRemoteStationManager selected does not support VHT rates");
-    }
-}
-
-/*This function is called if a wifi standard is being used which uses High Efficiency rates.
-*/
-void
-AarfWifiManager::SetHeSupported (bool enable)
-{
-  //HE is not supported by this algorithm.
-  if (enable)
-    {
-      NS_FATAL_ERROR ("WifiRemoteStationManager selected does not support HE rates");
-    }
-}
-
 } //namespace ns3
@@ -21,8 +21,7 @@
 #ifndef AARF_WIFI_MANAGER_H
 #define AARF_WIFI_MANAGER_H
 
-#include "ns3/traced-value.h"
-#include "wifi-remote-station-manager.h"
+#include "arf-family-wifi-manager.h"
 
 namespace ns3 {
 
@@ -35,11 +34,12 @@ namespace ns3 {
  * A Practical Approach</i>, by M. Lacage, M.H. Manshaei, and
  * T. Turletti.
  *
- * This RAA does not support HT, VHT nor HE modes and will error
- * exit if the user tries to configure this RAA with a Wi-Fi MAC
- * that has VhtSupported, HtSupported or HeSupported set.
+ * The state machine is shared with ARF in ArfFamilyWifiManager; AARF
+ * adapts the thresholds multiplicatively (AarfThresholdPolicy).
+ *
+ * HT, VHT and HE stations are handled by walking their MCS ladder.
  */
-class AarfWifiManager : public WifiRemoteStationManager
+class AarfWifiManager : public ArfFamilyWifiManager<AarfThresholdPolicy>
 {
 public:
   /**
@@ -49,36 +49,6 @@ public:
   static TypeId GetTypeId (void);
   AarfWifiManager ();
   virtual ~AarfWifiManager ();
-
-  // Inherited from WifiRemoteStationManager
-  void SetHtSupported (bool enable);
-  void SetVhtSupported (bool enable);
-  void SetHeSupported (bool enable);
-
-private:
-  //overriden from base class
-  WifiRemoteStation * DoCreateStation (void) const;
-  void DoReportRxOk (WifiRemoteStation *station,
-                     double rxSnr, WifiMode txMode);
-  void DoReportRtsFailed (WifiRemoteStation *station);
-  void DoReportDataFailed (WifiRemoteStation *station);
-  void DoReportRtsOk (WifiRemoteStation *station,
-                      double ctsSnr, WifiMode ctsMode, double rtsSnr);
-  void DoReportDataOk (WifiRemoteStation *station,
-                       double ackSnr, WifiMode ackMode, double dataSnr);
-  void DoReportFinalRtsFailed (WifiRemoteStation *station);
-  void DoReportFinalDataFailed (WifiRemoteStation *station);
-  WifiTxVector DoGetDataTxVector (WifiRemoteStation *station);
-  WifiTxVector DoGetRtsTxVector (WifiRemoteStation *station);
-  bool IsLowLatency (void) const;
-
-  uint32_t m_minTimerThreshold; ///< minimum timer threshold
-  uint32_t m_minSuccessThreshold; ///< minimum success threshold
-  double m_successK; ///< Multiplication factor for the success threshold
-  uint32_t m_maxSuccessThreshold; ///< maximum success threshold
-  double m_timerK; ///< Multiplication factor for the timer threshold
-
-  TracedValue<uint64_t> m_currentRate; //!< Trace rate changes
 };
 
 } //namespace ns3
@@ -0,0 +1,359 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Standalone comparison of the two ways of feeding a Block Ack to the
+ * ARF/AARF state machine (ArfFamilyRateControl): one UpdateOnAggregate
+ * call per aggregate, as DoReportAmpduTxStatus does, against one
+ * UpdateOnDataOk or UpdateOnDataFailed call per MPDU, in MPDU order.
+ *
+ * For each aggregate size the program reports:
+ * - the time per aggregate of both ways, on the same Gilbert-Elliott MPDU
+ *   outcomes, which do not depend on the rate;
+ * - the behavior of both ways on a channel whose MPDU loss ratio grows
+ *   with the rate index above a knee: mean rate index, rate changes per
+ *   1000 aggregates, fraction of the MPDUs delivered and goodput, the
+ *   mean over the MPDUs of the rate index plus one if delivered.
+ *
+ * The engine is header-only, so the program only needs the ns-3 headers:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-aggregate-update-check.cc
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "arf-family-wifi-manager.h"
+
+using namespace ns3;
+
+namespace {
+
+const uint32_t N_RATES = 8; ///< size of the ladder
+const uint32_t KNEE = 4; ///< highest rate index the channel supports without extra losses
+
+/**
+ * \brief outcomes of a sequence of aggregates of the same size
+ */
+struct Aggregates
+{
+  uint32_t m_size; ///< number of MPDUs per aggregate
+  std::vector<bool> m_mpdus; ///< outcome of each MPDU, true if acknowledged
+  std::vector<uint8_t> m_nSuccess; ///< acknowledged MPDUs of each aggregate
+  std::vector<uint8_t> m_nFailed; ///< MPDUs of each aggregate that were not acknowledged
+};
+
+/**
+ * \brief Gilbert-Elliott MPDU loss process
+ */
+class Channel
+{
+public:
+  /**
+   * \param seed the seed of the process
+   */
+  explicit Channel (uint32_t seed)
+    : m_rng (seed),
+      m_uniform (0, 1),
+      m_bad (false)
+  {
+  }
+  /**
+   * \param extraLoss the loss ratio added in the good state
+   * \return whether the MPDU is acknowledged
+   */
+  bool Send (double extraLoss)
+  {
+    m_bad = m_bad ? (m_uniform (m_rng) >= 0.1) : (m_uniform (m_rng) < 0.02);
+    return m_uniform (m_rng) >= (m_bad ? 0.7 : std::min (0.05 + extraLoss, 1.0));
+  }
+
+private:
+  std::mt19937 m_rng; ///< random number generator
+  std::uniform_real_distribution<double> m_uniform; ///< uniform distribution over [0, 1)
+  bool m_bad; ///< whether the channel is in the bad state
+};
+
+/**
+ * \param rate a rate index
+ * \return the loss ratio the channel adds at this rate
+ */
+double
+GetExtraLoss (uint32_t rate)
+{
+  return (rate > KNEE) ? 0.3 * (rate - KNEE) : 0;
+}
+
+/**
+ * \param size the number of MPDUs per aggregate
+ * \param nAggregates the number of aggregates
+ * \param seed the seed of the channel
+ * \return the outcomes, independent of the rate
+ */
+Aggregates
+MakeAggregates (uint32_t size, uint32_t nAggregates, uint32_t seed)
+{
+  Aggregates aggregates;
+  aggregates.m_size = size;
+  Channel channel (seed);
+  for (uint32_t k = 0; k < nAggregates; k++)
+    {
+      uint32_t nSuccess = 0;
+      for (uint32_t i = 0; i < size; i++)
+        {
+          bool ok = channel.Send (0);
+          aggregates.m_mpdus.push_back (ok);
+          nSuccess += ok;
+        }
+      aggregates.m_nSuccess.push_back (nSuccess);
+      aggregates.m_nFailed.push_back (size - nSuccess);
+    }
+  return aggregates;
+}
+
+/**
+ * \brief one aggregate fed to the engine as a single outcome
+ */
+struct BatchStep
+{
+  ArfFamilyState m_state; ///< the station state
+  const ArfFamilyRateControl<AarfThresholdPolicy> *m_control; ///< the engine
+  const Aggregates *m_aggregates; ///< the sequence
+
+  /**
+   * \param k the index of the aggregate
+   * \return the new rate
+   */
+  uint32_t operator() (uint32_t k)
+  {
+    m_control->UpdateOnAggregate (m_state, m_aggregates->m_nSuccess[k], m_aggregates->m_nFailed[k], N_RATES);
+    return m_state.GetRate ();
+  }
+};
+
+/**
+ * \brief one aggregate fed to the engine one MPDU at a time
+ */
+struct MpduStep
+{
+  ArfFamilyState m_state; ///< the station state
+  const ArfFamilyRateControl<AarfThresholdPolicy> *m_control; ///< the engine
+  const Aggregates *m_aggregates; ///< the sequence
+
+  /**
+   * \param k the index of the aggregate
+   * \return the new rate
+   */
+  uint32_t operator() (uint32_t k)
+  {
+    uint32_t size = m_aggregates->m_size;
+    for (uint32_t i = k * size; i < (k + 1) * size; i++)
+      {
+        if (m_aggregates->m_mpdus[i])
+          {
+            m_control->UpdateOnDataOk (m_state, N_RATES);
+          }
+        else
+          {
+            m_control->UpdateOnDataFailed (m_state);
+          }
+      }
+    return m_state.GetRate ();
+  }
+};
+
+/**
+ * Time the update of the state for all the aggregates of a sequence.
+ *
+ * \param nAggregates the number of aggregates
+ * \param rounds the number of times the sequence is replayed
+ * \param step the functor feeding one aggregate, returning the new rate
+ * \param checksum the sum of the rates, so that the replay is not optimized out
+ * \return the time taken, in seconds
+ */
+template <class Step>
+double
+TimeReplay (uint32_t nAggregates, uint32_t rounds, Step &step, uint64_t &checksum)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t k = 0; k < nAggregates; k++)
+        {
+          checksum += step (k);
+        }
+    }
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/**
+ * \brief behavior of one way of feeding the aggregates on the channel
+ */
+struct Behavior
+{
+  double m_meanRate; ///< mean rate index over the aggregates
+  double m_changesPerThousand; ///< rate changes per 1000 aggregates
+  double m_delivered; ///< fraction of the MPDUs acknowledged
+  double m_goodput; ///< mean over the MPDUs of the rate index plus one if acknowledged, 0 otherwise
+};
+
+/**
+ * Send aggregates on a channel whose losses depend on the rate.
+ *
+ * \param control the engine
+ * \param size the number of MPDUs per aggregate
+ * \param nAggregates the number of aggregates
+ * \param perMpdu whether the outcomes are fed one MPDU at a time
+ * \param seed the seed of the channel
+ * \return the behavior of the state machine
+ */
+Behavior
+Simulate (const ArfFamilyRateControl<AarfThresholdPolicy> &control, uint32_t size, uint32_t nAggregates,
+          bool perMpdu, uint32_t seed)
+{
+  ArfFamilyState state = ArfFamilyState ();
+  control.InitState (state);
+  Channel channel (seed);
+  uint64_t rateSum = 0;
+  uint64_t nDelivered = 0;
+  uint64_t goodput = 0;
+  uint32_t nChanges = 0;
+  for (uint32_t k = 0; k < nAggregates; k++)
+    {
+      uint32_t rate = state.GetRate ();
+      rateSum += rate;
+      uint32_t nSuccess = 0;
+      for (uint32_t i = 0; i < size; i++)
+        {
+          bool ok = channel.Send (GetExtraLoss (rate));
+          nSuccess += ok;
+          if (perMpdu)
+            {
+              if (ok)
+                {
+                  control.UpdateOnDataOk (state, N_RATES);
+                }
+              else
+                {
+                  control.UpdateOnDataFailed (state);
+                }
+            }
+        }
+      if (!perMpdu)
+        {
+          control.UpdateOnAggregate (state, nSuccess, size - nSuccess, N_RATES);
+        }
+      nDelivered += nSuccess;
+      goodput += static_cast<uint64_t> (nSuccess) * (rate + 1);
+      nChanges += (state.GetRate () != rate);
+    }
+  Behavior behavior;
+  behavior.m_meanRate = static_cast<double> (rateSum) / nAggregates;
+  behavior.m_changesPerThousand = 1000.0 * nChanges / nAggregates;
+  behavior.m_delivered = static_cast<double> (nDelivered) / (static_cast<double> (size) * nAggregates);
+  behavior.m_goodput = static_cast<double> (goodput) / (static_cast<double> (size) * nAggregates);
+  return behavior;
+}
+
+} //anonymous namespace
+
+int
+main (void)
+{
+  ArfFamilyRateControl<AarfThresholdPolicy> aarf;
+  aarf.m_minTimerThreshold = 15;
+  aarf.m_minSuccessThreshold = 10;
+  aarf.m_successK = 2;
+  aarf.m_timerK = 2;
+  aarf.m_maxSuccessThreshold = 60;
+
+  const uint32_t sizes[] = {1, 2, 4, 8, 16, 32, 64};
+  const uint32_t nMpdus = 1 << 20;
+  const uint32_t repetitions = 15;
+  const uint32_t rounds = 4;
+
+  std::cout << std::setw (5) << "size"
+            << std::setw (12) << "batch ns"
+            << std::setw (12) << "mpdu ns"
+            << std::setw (9) << "speedup"
+            << std::setw (12) << "batch rate"
+            << std::setw (10) << "changes"
+            << std::setw (11) << "delivered"
+            << std::setw (9) << "goodput"
+            << std::setw (11) << "mpdu rate"
+            << std::setw (10) << "changes"
+            << std::setw (11) << "delivered"
+            << std::setw (9) << "goodput" << std::endl;
+  uint64_t checksum = 0;
+  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s++)
+    {
+      uint32_t size = sizes[s];
+      uint32_t nAggregates = nMpdus / size;
+      Aggregates aggregates = MakeAggregates (size, nAggregates, 1);
+
+      BatchStep batch;
+      batch.m_state = ArfFamilyState ();
+      aarf.InitState (batch.m_state);
+      batch.m_control = &aarf;
+      batch.m_aggregates = &aggregates;
+      MpduStep perMpdu;
+      perMpdu.m_state = ArfFamilyState ();
+      aarf.InitState (perMpdu.m_state);
+      perMpdu.m_control = &aarf;
+      perMpdu.m_aggregates = &aggregates;
+
+      //both ways take turns and the fastest replay of each is kept
+      double bestBatch = 0;
+      double bestMpdu = 0;
+      for (uint32_t k = 0; k < repetitions; k++)
+        {
+          double seconds = TimeReplay (nAggregates, rounds, batch, checksum);
+          bestBatch = (k == 0) ? seconds : std::min (bestBatch, seconds);
+          seconds = TimeReplay (nAggregates, rounds, perMpdu, checksum);
+          bestMpdu = (k == 0) ? seconds : std::min (bestMpdu, seconds);
+        }
+      double n = static_cast<double> (rounds) * nAggregates;
+
+      Behavior batchBehavior = Simulate (aarf, size, nAggregates, false, 2);
+      Behavior mpduBehavior = Simulate (aarf, size, nAggregates, true, 2);
+
+      std::cout << std::setw (5) << size << std::fixed
+                << std::setprecision (2)
+                << std::setw (12) << bestBatch * 1e9 / n
+                << std::setw (12) << bestMpdu * 1e9 / n
+                << std::setw (9) << bestMpdu / bestBatch
+                << std::setw (12) << batchBehavior.m_meanRate
+                << std::setprecision (1)
+                << std::setw (10) << batchBehavior.m_changesPerThousand
+                << std::setprecision (3)
+                << std::setw (11) << batchBehavior.m_delivered
+                << std::setprecision (2)
+                << std::setw (9) << batchBehavior.m_goodput
+                << std::setprecision (2)
+                << std::setw (11) << mpduBehavior.m_meanRate
+                << std::setprecision (1)
+                << std::setw (10) << mpduBehavior.m_changesPerThousand
+                << std::setprecision (3)
+                << std::setw (11) << mpduBehavior.m_delivered
+                << std::setprecision (2)
+                << std::setw (9) << mpduBehavior.m_goodput << std::endl;
+    }
+  std::cout << "(checksum " << checksum << ")" << std::endl;
+  return 0;
+}
@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARF_FAMILY_STATION_POOL_H
+#define ARF_FAMILY_STATION_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+#include <vector>
+#include "ns3/assert.h"
+#include "ns3/unused.h"
+
+namespace ns3 {
+
+/**
+ * \brief slab allocator for the station objects of one ARF family manager
+ *
+ * Objects are carved out of contiguous slabs of SLAB_SIZE slots and
+ * released objects are kept on a free list, so association churn reuses
+ * memory in O(1) and stations created together stay close in memory.
+ *
+ * WifiRemoteStationManager deletes the stations itself, through their
+ * virtual destructor, so each slot starts with a pointer to its pool and
+ * Deallocate finds the pool from the object alone. The manager owns its
+ * pools and calls Release when it is destroyed: the slabs are returned to
+ * the heap at once, or when the last object is deallocated if some are
+ * still alive.
+ *
+ * A pool is only used by the stations of its manager, which belong to a
+ * single simulation, so it needs no locking: managers of simulations run
+ * in different threads do not share any allocator state.
+ */
+class ArfFamilyStationPool
+{
+public:
+  /**
+   * \param size the size of the objects
+   * \param alignment the alignment of the objects, at most the one of a pointer
+   */
+  ArfFamilyStationPool (size_t size, size_t alignment)
+    : m_slotSize (((sizeof (ArfFamilyStationPool *) + size + sizeof (void *) - 1) / sizeof (void *)) * sizeof (void *)),
+      m_objectSize (size),
+      m_free (0),
+      m_nLive (0),
+      m_released (false)
+  {
+    NS_UNUSED (alignment);
+    NS_ASSERT (alignment <= sizeof (void *));
+  }
+  /**
+   * \param size the size of the object
+   * \return storage for the object
+   */
+  void * Allocate (size_t size)
+  {
+    NS_UNUSED (size);
+    NS_ASSERT (size <= m_objectSize);
+    if (m_free == 0)
+      {
+        Grow ();
+      }
+    char *slot = m_free;
+    m_free = *reinterpret_cast<char **> (slot);
+    *reinterpret_cast<ArfFamilyStationPool **> (slot) = this;
+    m_nLive++;
+    return slot + sizeof (ArfFamilyStationPool *);
+  }
+  /**
+   * \param p storage returned by Allocate, or 0
+   */
+  static void Deallocate (void *p)
+  {
+    if (p == 0)
+      {
+        return;
+      }
+    char *slot = static_cast<char *> (p) - sizeof (ArfFamilyStationPool *);
+    ArfFamilyStationPool *pool = *reinterpret_cast<ArfFamilyStationPool **> (slot);
+    *reinterpret_cast<char **> (slot) = pool->m_free;
+    pool->m_free = slot;
+    pool->m_nLive--;
+    if (pool->m_released && pool->m_nLive == 0)
+      {
+        delete pool;
+      }
+  }
+  /**
+   * Give up the pool: it is deleted with its slabs now if no object is
+   * alive, or when the last one is deallocated.
+   */
+  void Release (void)
+  {
+    m_released = true;
+    if (m_nLive == 0)
+      {
+        delete this;
+      }
+  }
+
+private:
+  static const uint32_t SLAB_SIZE = 256; ///< number of slots per slab
+
+  ~ArfFamilyStationPool ()
+  {
+    for (std::vector<char *>::const_iterator i = m_slabs.begin (); i != m_slabs.end (); i++)
+      {
+        ::operator delete (*i);
+      }
+  }
+  /**
+   * Allocate a new slab and thread its slots onto the free list.
+   */
+  void Grow (void)
+  {
+    char *slab = static_cast<char *> (::operator new (SLAB_SIZE * m_slotSize));
+    m_slabs.push_back (slab);
+    for (uint32_t i = SLAB_SIZE; i > 0; i--)
+      {
+        char *slot = slab + (i - 1) * m_slotSize;
+        *reinterpret_cast<char **> (slot) = m_free;
+        m_free = slot;
+      }
+  }
+
+  size_t m_slotSize; ///< size of a slot: the pool pointer and the object, rounded up to a pointer
+  size_t m_objectSize; ///< size of the objects
+  char *m_free; ///< head of the free list, linked through the first word of the slots
+  std::vector<char *> m_slabs; ///< all the slabs allocated so far
+  uint32_t m_nLive; ///< number of objects allocated and not deallocated yet
+  bool m_released; ///< whether the owner gave up the pool
+};
+
+} //namespace ns3
+
+#endif /* ARF_FAMILY_STATION_POOL_H */
@@ -0,0 +1,2618 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2004,2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+
+#include "arf-family-wifi-manager.h"
+#include <cmath>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "arf-family-station-pool.h"
+#include "wifi-phy.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ArfFamilyWifiManager");
+
+/**
+ * \brief statistics of a station, linked into the list of its manager
+ *
+ * Records are allocated from an ArfFamilyStationPool of the manager and
+ * owned by the extension of their station. The manager keeps them in a
+ * circular list around a sentinel record, so that a record unlinks itself
+ * when its station is deleted without having to know its manager.
+ */
+struct ArfFamilyStatsRecord
+{
+  ArfFamilyStationStats m_stats; ///< the statistics
+  Mac48Address m_address; ///< address of the peer of the station
+  uint8_t m_tid; ///< TID of the station
+  ArfFamilyStatsRecord *m_prev; ///< previous record of the list
+  ArfFamilyStatsRecord *m_next; ///< next record of the list
+
+  ArfFamilyStatsRecord ()
+    : m_tid (0),
+      m_prev (this),
+      m_next (this)
+  {
+  }
+  ~ArfFamilyStatsRecord ()
+  {
+    Unlink ();
+  }
+  /**
+   * Insert the record into a list.
+   *
+   * \param sentinel the sentinel of the list, the record goes last
+   */
+  void Link (ArfFamilyStatsRecord *sentinel)
+  {
+    m_next = sentinel;
+    m_prev = sentinel->m_prev;
+    m_prev->m_next = this;
+    sentinel->m_prev = this;
+  }
+  /**
+   * Remove the record from its list, if any.
+   */
+  void Unlink (void)
+  {
+    m_prev->m_next = m_next;
+    m_next->m_prev = m_prev;
+    m_prev = this;
+    m_next = this;
+  }
+  /**
+   * Records are allocated from a pool of the manager.
+   *
+   * \param size the size of the object
+   * \param pool the pool to allocate from
+   * \return storage for the record
+   */
+  static void * operator new (size_t size, ArfFamilyStationPool *pool)
+  {
+    return pool->Allocate (size);
+  }
+  /**
+   * Records are returned to the pool they came from.
+   *
+   * \param p the storage of the record
+   */
+  static void operator delete (void *p)
+  {
+    ArfFamilyStationPool::Deallocate (p);
+  }
+  /**
+   * Return the storage of a record whose constructor threw.
+   *
+   * \param p the storage of the record
+   * \param pool the pool the storage came from
+   */
+  static void operator delete (void *p, ArfFamilyStationPool *pool)
+  {
+    NS_UNUSED (pool);
+    ArfFamilyStationPool::Deallocate (p);
+  }
+};
+
+/**
+ * \brief per-station state of the optional modes of the ARF family managers
+ *
+ * Only the RTS rate adaptation, collision-aware RTS, power control, staged
+ * fallback, time-based timer, SNR-aided, fast-start, loss window, rate memory,
+ * final failure and statistics modes use this state, so it lives in a side
+ * allocation that is only made for the stations of a manager with one of
+ * these modes enabled. It is allocated from an ArfFamilyStationPool of the
+ * manager and owned by its station.
+ */
+struct ArfFamilyStationExtension
+{
+  ArfFamilyCompactState m_rtsState; ///< state of the RTS rate controller
+  Time m_timerStart; ///< last time the timer was reset, for the time-based timer
+  Time m_rememberedTime; ///< last time the station was recorded in the rate memory
+  double m_snr; ///< average of the reported SNRs (linear)
+  double m_fastStartSnr; ///< first SNR (linear) reported for the station, 0 if none
+  ArfFamilyStatsRecord *m_stats; ///< statistics of the station, 0 until needed
+  ArfLossWindow m_lossWindow; ///< last outcomes, in loss window mode
+  uint32_t m_protectionSuccess; ///< successful transmissions since protection was turned on
+  uint32_t m_stagedRate; ///< rate of the first staged fallback stage of the current packet
+  uint32_t m_stagedAttempt; ///< attempts already made for the current packet in staged fallback mode
+  uint32_t m_holdOff; ///< successes left before the rate may be increased again
+  uint32_t m_rememberedRate; ///< rate last recorded in the rate memory
+  uint8_t m_powerLevel; ///< last transmit power level used for the station
+  bool m_protection; ///< whether the collision-aware mode protects the station with RTS/CTS
+  bool m_rtsUsed; ///< whether a CTS was received for the data frame being sent
+  bool m_snrValid; ///< whether m_snr holds at least one report
+  bool m_fastStartDone; ///< whether the fast-start mode already seeded the rate
+  bool m_restoreTried; ///< whether the rate memory was looked up for the station
+
+  ~ArfFamilyStationExtension ()
+  {
+    delete m_stats;
+  }
+  /**
+   * Extensions are allocated from a pool of the manager.
+   *
+   * \param size the size of the object
+   * \param pool the pool to allocate from
+   * \return storage for the extension
+   */
+  static void * operator new (size_t size, ArfFamilyStationPool *pool)
+  {
+    return pool->Allocate (size);
+  }
+  /**
+   * Extensions are returned to the pool they came from.
+   *
+   * \param p the storage of the extension
+   */
+  static void operator delete (void *p)
+  {
+    ArfFamilyStationPool::Deallocate (p);
+  }
+  /**
+   * Return the storage of an extension whose constructor threw.
+   *
+   * \param p the storage of the extension
+   * \param pool the pool the storage came from
+   */
+  static void operator delete (void *p, ArfFamilyStationPool *pool)
+  {
+    NS_UNUSED (pool);
+    ArfFamilyStationPool::Deallocate (p);
+  }
+};
+
+/**
+ * \brief hold per-remote-station state for the ARF family Wifi managers.
+ *
+ * This struct extends from WifiRemoteStation struct to hold additional
+ * information required by the ARF family Wifi managers. The state of the
+ * ARF state machine itself is added by ArfFamilyStateStation, in full or
+ * compact form, and the state of the optional modes by
+ * ArfFamilyStationExtension, only when one of them is enabled.
+ *
+ * On an LP64 host a station takes 96 bytes with the compact state and
+ * 120 bytes with the full state, 16 of which are WifiRemoteStation and 24
+ * the cached WifiTxVector; a pool slot adds a pointer to its pool (104 and
+ * 128 bytes). A manager with any optional mode enabled adds an 88-byte
+ * extension (96 in the pool) per station. Supported rates are held by the
+ * base class, and the statistics, when enabled, by a record of the
+ * extension, allocated from a pool of the manager as well.
+ */
+struct ArfFamilyWifiRemoteStation : public WifiRemoteStation
+{
+  ArfFamilyWifiRemoteStation ()
+    : m_extension (0)
+  {
+  }
+  virtual ~ArfFamilyWifiRemoteStation ()
+  {
+    delete m_extension;
+  }
+
+  const ArfRateLadder *m_ladder; ///< rate ladder for this station
+  const ArfRateLadder *m_txVectorLadder; ///< rate ladder the cached tx vector was built from
+  ArfFamilyStationExtension *m_extension; ///< state of the optional modes, 0 until needed
+  uint64_t m_txVectorDataRate; ///< data rate (b/s) of the cached tx vector
+  uint64_t m_tracedDataRate; ///< data rate (b/s) last reported by the RateChange trace, 0 if none
+  WifiTxVector m_txVector; ///< cached data tx vector
+  uint32_t m_txVectorRate; ///< rate index the cached tx vector was built for
+  bool m_txVectorAggregation; ///< aggregation setting the cached tx vector was built for
+  bool m_txVectorValid; ///< whether the cached tx vector has been built
+};
+
+/**
+ * \brief ARF family station holding the state machine in a given representation
+ */
+template <class State>
+struct ArfFamilyStateStation : public ArfFamilyWifiRemoteStation
+{
+  State m_arf; ///< state of the ARF state machine
+
+  /**
+   * Stations are allocated from a pool of the manager.
+   *
+   * \param size the size of the object
+   * \param pool the pool to allocate from
+   * \return storage for the station
+   */
+  static void * operator new (size_t size, ArfFamilyStationPool *pool)
+  {
+    return pool->Allocate (size);
+  }
+  /**
+   * Stations are returned to the pool they came from.
+   *
+   * \param p the storage of the station
+   */
+  static void operator delete (void *p)
+  {
+    ArfFamilyStationPool::Deallocate (p);
+  }
+  /**
+   * Return the storage of a station whose constructor threw.
+   *
+   * \param p the storage of the station
+   * \param pool the pool the storage came from
+   */
+  static void operator delete (void *p, ArfFamilyStationPool *pool)
+  {
+    NS_UNUSED (pool);
+    ArfFamilyStationPool::Deallocate (p);
+  }
+};
+
+/// station using the full state
+typedef ArfFamilyStateStation<ArfFamilyState> ArfFamilyFullStation;
+/// station using the bit-packed state
+typedef ArfFamilyStateStation<ArfFamilyCompactState> ArfFamilyCompactStation;
+
+static_assert (sizeof (ArfFamilyCompactState) <= 8, "ArfFamilyCompactState must fit in 8 bytes");
+
+/*
+ * Operations on the state of a station, applied to either representation of
+ * the state by ArfFamilyWifiManager::ApplyToState.
+ */
+namespace {
+
+/**
+ * \brief read the rate index
+ */
+struct ArfStateGetRate
+{
+  typedef uint32_t Result; ///< result of the operation
+
+  /**
+   * \param state the state
+   * \return the rate index
+   */
+  template <class State>
+  uint32_t operator() (const State &state) const
+  {
+    return state.GetRate ();
+  }
+};
+
+/**
+ * \brief set the rate index
+ */
+struct ArfStateSetRate
+{
+  typedef void Result; ///< result of the operation
+
+  /**
+   * \param rate the new rate index
+   */
+  explicit ArfStateSetRate (uint32_t rate)
+    : m_rate (rate)
+  {
+  }
+  /**
+   * \param state the state
+   */
+  template <class State>
+  void operator() (State &state) const
+  {
+    state.SetRate (m_rate);
+  }
+
+  uint32_t m_rate; ///< the new rate index
+};
+
+/**
+ * \brief read the packet count of the timer
+ */
+struct ArfStateGetTimer
+{
+  typedef uint32_t Result; ///< result of the operation
+
+  /**
+   * \param state the state
+   * \return the packet count of the timer
+   */
+  template <class State>
+  uint32_t operator() (const State &state) const
+  {
+    return state.GetTimer ();
+  }
+};
+
+/**
+ * \brief read the timer timeout, as stored in the state
+ */
+struct ArfStateGetTimerTimeout
+{
+  typedef uint32_t Result; ///< result of the operation
+
+  /**
+   * \param state the state
+   * \return the timer timeout
+   */
+  template <class State>
+  uint32_t operator() (const State &state) const
+  {
+    return state.GetTimerTimeout ();
+  }
+};
+
+/**
+ * \brief reset the packet count of the timer
+ */
+struct ArfStateResetTimer
+{
+  typedef void Result; ///< result of the operation
+
+  /**
+   * \param state the state
+   */
+  template <class State>
+  void operator() (State &state) const
+  {
+    state.ResetTimer ();
+  }
+};
+
+/**
+ * \brief read the largest ladder the state can index
+ */
+struct ArfStateGetMaxRates
+{
+  typedef uint32_t Result; ///< result of the operation
+
+  /**
+   * \param state the state
+   * \return the largest ladder the state can index
+   */
+  template <class State>
+  uint32_t operator() (const State &state) const
+  {
+    NS_UNUSED (state);
+    return State::MAX_RATES;
+  }
+};
+
+/**
+ * \brief copy the operating point of the state into a rate memory entry
+ */
+struct ArfStateGetEntry
+{
+  typedef bool Result; ///< result of the operation
+
+  /**
+   * \param entry the entry to fill
+   */
+  explicit ArfStateGetEntry (ArfRateMemoryEntry &entry)
+    : m_entry (entry)
+  {
+  }
+  /**
+   * \param state the state
+   * \return whether the state is in recovery mode
+   */
+  template <class State>
+  bool operator() (const State &state) const
+  {
+    m_entry.m_rate = state.GetRate ();
+    m_entry.m_successThreshold = state.GetSuccessThreshold ();
+    m_entry.m_timerTimeout = state.GetTimerTimeout ();
+    return state.GetRecovery ();
+  }
+
+  ArfRateMemoryEntry &m_entry; ///< the entry to fill
+};
+
+/**
+ * \brief restore the operating point of a rate memory entry
+ */
+struct ArfStateSetEntry
+{
+  typedef void Result; ///< result of the operation
+
+  /**
+   * \param entry the entry to restore
+   */
+  explicit ArfStateSetEntry (const ArfRateMemoryEntry &entry)
+    : m_entry (entry)
+  {
+  }
+  /**
+   * \param state the state
+   */
+  template <class State>
+  void operator() (State &state) const
+  {
+    state.SetRate (m_entry.m_rate);
+    state.SetSuccessThreshold (m_entry.m_successThreshold);
+    state.SetTimerTimeout (m_entry.m_timerTimeout);
+  }
+
+  const ArfRateMemoryEntry &m_entry; ///< the entry to restore
+};
+
+/**
+ * \brief feed a data failure to the state machine
+ */
+template <class Policy>
+struct ArfStateDataFailed
+{
+  typedef bool Result; ///< result of the operation
+
+  /**
+   * \param control the state machine
+   */
+  explicit ArfStateDataFailed (const ArfFamilyRateControl<Policy> &control)
+    : m_control (control)
+  {
+  }
+  /**
+   * \param state the state
+   * \return whether the rate went down
+   */
+  template <class State>
+  bool operator() (State &state) const
+  {
+    return m_control.UpdateOnDataFailed (state);
+  }
+
+  const ArfFamilyRateControl<Policy> &m_control; ///< the state machine
+};
+
+/**
+ * \brief feed a data success to the state machine
+ */
+template <class Policy>
+struct ArfStateDataOk
+{
+  typedef bool Result; ///< result of the operation
+
+  /**
+   * \param control the state machine
+   * \param nRates the number of rates of the station
+   */
+  ArfStateDataOk (const ArfFamilyRateControl<Policy> &control, uint32_t nRates)
+    : m_control (control),
+      m_nRates (nRates),
+      m_timeBased (false),
+      m_timerExpired (false)
+  {
+  }
+  /**
+   * \param control the state machine
+   * \param nRates the number of rates of the station
+   * \param timerExpired whether the time-based timer expired
+   */
+  ArfStateDataOk (const ArfFamilyRateControl<Policy> &control, uint32_t nRates, bool timerExpired)
+    : m_control (control),
+      m_nRates (nRates),
+      m_timeBased (true),
+      m_timerExpired (timerExpired)
+  {
+  }
+  /**
+   * \param state the state
+   * \return whether the rate went up
+   */
+  template <class State>
+  bool operator() (State &state) const
+  {
+    if (m_timeBased)
+      {
+        return m_control.UpdateOnDataOk (state, m_nRates, m_timerExpired);
+      }
+    return m_control.UpdateOnDataOk (state, m_nRates);
+  }
+
+  const ArfFamilyRateControl<Policy> &m_control; ///< the state machine
+  uint32_t m_nRates; ///< the number of rates of the station
+  bool m_timeBased; ///< whether the timer is time-based
+  bool m_timerExpired; ///< whether the time-based timer expired
+};
+
+/**
+ * \brief feed the outcome of an aggregate to the state machine
+ */
+template <class Policy>
+struct ArfStateAggregate
+{
+  typedef bool Result; ///< result of the operation
+
+  /**
+   * \param control the state machine
+   * \param nSuccess the number of successful MPDUs
+   * \param nFailed the number of failed MPDUs
+   * \param nRates the number of rates of the station
+   */
+  ArfStateAggregate (const ArfFamilyRateControl<Policy> &control, uint32_t nSuccess, uint32_t nFailed,
+                     uint32_t nRates)
+    : m_control (control),
+      m_nSuccess (nSuccess),
+      m_nFailed (nFailed),
+      m_nRates (nRates),
+      m_timeBased (false),
+      m_timerExpired (false)
+  {
+  }
+  /**
+   * \param control the state machine
+   * \param nSuccess the number of successful MPDUs
+   * \param nFailed the number of failed MPDUs
+   * \param nRates the number of rates of the station
+   * \param timerExpired whether the time-based timer expired
+   */
+  ArfStateAggregate (const ArfFamilyRateControl<Policy> &control, uint32_t nSuccess, uint32_t nFailed,
+                     uint32_t nRates, bool timerExpired)
+    : m_control (control),
+      m_nSuccess (nSuccess),
+      m_nFailed (nFailed),
+      m_nRates (nRates),
+      m_timeBased (true),
+      m_timerExpired (timerExpired)
+  {
+  }
+  /**
+   * \param state the state
+   * \return whether the rate changed
+   */
+  template <class State>
+  bool operator() (State &state) const
+  {
+    if (m_timeBased)
+      {
+        return m_control.UpdateOnAggregate (state, m_nSuccess, m_nFailed, m_nRates, m_timerExpired);
+      }
+    return m_control.UpdateOnAggregate (state, m_nSuccess, m_nFailed, m_nRates);
+  }
+
+  const ArfFamilyRateControl<Policy> &m_control; ///< the state machine
+  uint32_t m_nSuccess; ///< the number of successful MPDUs
+  uint32_t m_nFailed; ///< the number of failed MPDUs
+  uint32_t m_nRates; ///< the number of rates of the station
+  bool m_timeBased; ///< whether the timer is time-based
+  bool m_timerExpired; ///< whether the time-based timer expired
+};
+
+/**
+ * \brief move the state to a given rate, as a probe if it goes up
+ */
+template <class Policy>
+struct ArfStateJumpToRate
+{
+  typedef bool Result; ///< result of the operation
+
+  /**
+   * \param control the state machine
+   * \param rate the target rate index
+   */
+  ArfStateJumpToRate (const ArfFamilyRateControl<Policy> &control, uint32_t rate)
+    : m_control (control),
+      m_rate (rate)
+  {
+  }
+  /**
+   * \param state the state
+   * \return whether the rate changed
+   */
+  template <class State>
+  bool operator() (State &state) const
+  {
+    return m_control.JumpToRate (state, m_rate);
+  }
+
+  const ArfFamilyRateControl<Policy> &m_control; ///< the state machine
+  uint32_t m_rate; ///< the target rate index
+};
+
+/**
+ * \brief move the state down to a given rate
+ */
+template <class Policy>
+struct ArfStateFallBackTo
+{
+  typedef bool Result; ///< result of the operation
+
+  /**
+   * \param control the state machine
+   * \param rate the target rate index
+   */
+  ArfStateFallBackTo (const ArfFamilyRateControl<Policy> &control, uint32_t rate)
+    : m_control (control),
+      m_rate (rate)
+  {
+  }
+  /**
+   * \param state the state
+   * \return whether the rate changed
+   */
+  template <class State>
+  bool operator() (State &state) const
+  {
+    return m_control.FallBackTo (state, m_rate);
+  }
+
+  const ArfFamilyRateControl<Policy> &m_control; ///< the state machine
+  uint32_t m_rate; ///< the target rate index
+};
+
+/**
+ * \brief copy the state into the statistics of the station, counting the
+ * transitions since the last copy
+ *
+ * A failed probe is counted when the rate goes down while the station was
+ * in recovery mode, that is when the first transmissions at a newly tried
+ * rate failed.
+ */
+template <class Policy>
+struct ArfStateRecord
+{
+  typedef void Result; ///< result of the operation
+
+  /**
+   * \param control the state machine
+   * \param stats the statistics of the station
+   */
+  ArfStateRecord (const ArfFamilyRateControl<Policy> &control, ArfFamilyStationStats &stats)
+    : m_control (control),
+      m_stats (stats)
+  {
+  }
+  /**
+   * \param state the state
+   */
+  template <class State>
+  void operator() (const State &state) const
+  {
+    uint32_t rate = state.GetRate ();
+    if (rate != m_stats.m_rate)
+      {
+        m_stats.AccountTime (Simulator::Now ());
+        if (rate > m_stats.m_rate)
+          {
+            m_stats.m_nIncreases++;
+          }
+        else
+          {
+            m_stats.m_nDecreases++;
+            m_stats.m_nFailedProbes += m_stats.m_recovery;
+          }
+        m_stats.m_rate = rate;
+      }
+    if (state.GetRecovery () && !m_stats.m_recovery)
+      {
+        m_stats.m_nRecoveries++;
+      }
+    m_stats.m_recovery = state.GetRecovery ();
+    m_stats.m_successThreshold = m_control.GetSuccessThreshold (state.GetSuccessThreshold ());
+    m_stats.m_timerTimeout = m_control.GetTimerTimeout (state.GetTimerTimeout ());
+  }
+
+  const ArfFamilyRateControl<Policy> &m_control; ///< the state machine
+  ArfFamilyStationStats &m_stats; ///< the statistics of the station
+};
+
+} //anonymous namespace
+
+template <class Policy>
+TypeId
+ArfFamilyWifiManager<Policy>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (("ns3::ArfFamilyWifiManager<" + Policy::GetName () + ">").c_str ())
+    .SetParent<WifiRemoteStationManager> ()
+    .SetGroupName ("Wifi")
+    .AddAttribute ("CompactStationState",
+                   "Keep the per-station state in a bit-packed 8-byte form. Counters "
+                   "saturate, thresholds are limited to 255 (success) and 65535 (timer) "
+                   "and ladders to 128 rates; larger values stop the simulation. Transitions are "
+                   "slower than with the full state, so this only pays off with many stations.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_compactState),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ChannelWidthAdaptation",
+                   "Adapt the channel width together with the MCS: the ladder of HT, "
+                   "VHT and HE stations climbs the MCSs of 20 MHz, then those of each "
+                   "wider channel width, up to the common one, that are faster than "
+                   "every MCS of the narrower widths.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_channelWidthAdaptation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("GoodputLadder",
+                   "Order legacy rate ladders by expected goodput instead of the supported "
+                   "set order, and leave out the rates that a faster rate needing no more "
+                   "SNR dominates.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_goodputLadder),
+                   MakeBooleanChecker ())
+    .AddAttribute ("GoodputFrameSize",
+                   "The frame size (bytes) the goodput of the rates is computed for.",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_goodputFrameSize),
+                   MakeUintegerChecker<uint32_t> (1, 65535))
+    .AddAttribute ("RtsRateAdaptation",
+                   "Adapt the rate of RTS frames with a separate ARF controller "
+                   "within the BasicRateSet instead of always using the lowest rate.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_rtsRateAdaptation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RtsTimerThreshold",
+                   "The 'timer' threshold of the RTS rate controller, at most 65535 "
+                   "since the controller keeps a compact state.",
+                   UintegerValue (15),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_rtsTimerThreshold),
+                   MakeUintegerChecker<uint32_t> (0, 0xffff))
+    .AddAttribute ("RtsSuccessThreshold",
+                   "The minimum number of successful RTS transmissions to try a new RTS rate, "
+                   "at most 255 since the controller keeps a compact state.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_rtsSuccessThreshold),
+                   MakeUintegerChecker<uint32_t> (0, 0xff))
+    .AddAttribute ("PowerControl",
+                   "Adapt the transmit power along with the rate: lower it on success "
+                   "streaks at the fastest rate and raise it before lowering the rate "
+                   "on failures (PARF/APARF).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_powerControl),
+                   MakeBooleanChecker ())
+    .AddAttribute ("StagedFallback",
+                   "Retry each packet in fixed stages (its first rate, the next lower "
+                   "rate, the lowest rate), the first rate being taken from the state "
+                   "machine at the first attempt, instead of following the state "
+                   "machine at every attempt. This is not a multi-rate retry chain: "
+                   "nothing is handed to the MAC, the tx vector of each attempt is "
+                   "still asked for separately.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_stagedFallback),
+                   MakeBooleanChecker ())
+    .AddAttribute ("StagedFallbackCurrentTries",
+                   "The number of tries at the first rate of a packet in staged fallback mode.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_stagedFallbackCurrentTries),
+                   MakeUintegerChecker<uint32_t> (1, 255))
+    .AddAttribute ("StagedFallbackLowerTries",
+                   "The number of tries at the next lower rate in staged fallback mode.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_stagedFallbackLowerTries),
+                   MakeUintegerChecker<uint32_t> (0, 255))
+    .AddAttribute ("StagedFallbackLowestTries",
+                   "The number of tries at the lowest rate in staged fallback mode.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_stagedFallbackLowestTries),
+                   MakeUintegerChecker<uint32_t> (0, 255))
+    .AddAttribute ("TimeBasedTimer",
+                   "Let the timer expire after ProbeInterval of simulation time "
+                   "instead of after a number of transmissions.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_timeBasedTimer),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProbeInterval",
+                   "The interval after which the time-based timer expires and a "
+                   "higher rate is probed.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&ArfFamilyWifiManager<Policy>::m_probeInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("SnrAided",
+                   "Keep an average of the reported SNRs per station and jump several "
+                   "rates up or down when it clearly supports another rate.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_snrAided),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SnrAlpha",
+                   "Weight of a new SNR report in the per-station SNR average.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&ArfFamilyWifiManager<Policy>::m_snrAlpha),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("SnrMargin",
+                   "Margin (dB) the SNR average must keep above the SNR threshold "
+                   "of a rate before the SNR-aided mode uses it.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&ArfFamilyWifiManager<Policy>::SetSnrMargin,
+                                       &ArfFamilyWifiManager<Policy>::GetSnrMargin),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrBer",
+                   "The target BER the SNR thresholds of the SNR-aided mode are computed for.",
+                   DoubleValue (1e-6),
+                   MakeDoubleAccessor (&ArfFamilyWifiManager<Policy>::m_snrBer),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("FastStart",
+                   "Seed the rate of a new station from the first SNR reported for it "
+                   "instead of starting at the lowest rate. The seeded rate is probed "
+                   "like any rate increase.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_fastStart),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FastStartSnrTable",
+                   "Comma-separated \"snrDb:index\" pairs mapping the first SNR of a station "
+                   "to its initial rate index, e.g. \"5:1,12:4,20:7\": the pair with the "
+                   "highest SNR below the reported one is used. If empty, the SNR thresholds "
+                   "of the ladder and SnrMargin are used instead.",
+                   StringValue (""),
+                   MakeStringAccessor (&ArfFamilyWifiManager<Policy>::m_fastStartTableString),
+                   MakeStringChecker ())
+    .AddAttribute ("RateMemorySize",
+                   "The number of peers whose last rate and thresholds are kept across "
+                   "reassociations (0 to disable).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_rateMemorySize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RateMemoryLifetime",
+                   "The age after which the remembered rate of a peer is not used anymore.",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&ArfFamilyWifiManager<Policy>::m_rateMemoryLifetime),
+                   MakeTimeChecker ())
+    .AddAttribute ("LossWindow",
+                   "Take the rate decisions on the loss ratio of a window of the last "
+                   "outcomes of the station instead of on consecutive successes and "
+                   "failures (RRAA-like).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_lossWindowMode),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LossWindowSize",
+                   "The number of outcomes in the loss window.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_lossWindowSize),
+                   MakeUintegerChecker<uint32_t> (1, 32))
+    .AddAttribute ("LossWindowRaiseThreshold",
+                   "The loss ratio of a full window at or below which the rate goes up.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&ArfFamilyWifiManager<Policy>::m_lossWindowRaiseThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("LossWindowLowerThreshold",
+                   "The loss ratio of the window at or above which the rate goes down.",
+                   DoubleValue (0.4),
+                   MakeDoubleAccessor (&ArfFamilyWifiManager<Policy>::m_lossWindowLowerThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("FinalFailureSteps",
+                   "The number of rates a station falls back when a packet is dropped "
+                   "after its last retry (0 for no reaction beyond FinalFailureFloor).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_finalFailureSteps),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FinalFailureFloor",
+                   "The highest rate index a station keeps when a packet is dropped after "
+                   "its last retry, to fall straight to a safe rate.",
+                   UintegerValue (0xffffffff),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_finalFailureFloor),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FinalFailureHoldOff",
+                   "The number of successful transmissions after a dropped packet during "
+                   "which the rate is not increased.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_finalFailureHoldOff),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CollisionAwareRts",
+                   "Handle a failure without RTS/CTS as a possible collision: turn "
+                   "RTS/CTS on for the station instead of falling back, and only fall "
+                   "back when protected frames fail (CARA).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_collisionAwareRts),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProtectionSuccessThreshold",
+                   "The number of successful transmissions after which the "
+                   "collision-aware mode turns RTS/CTS off again.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&ArfFamilyWifiManager<Policy>::m_protectionSuccessThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Statistics",
+                   "Keep rate control statistics per station, see GetStationStats.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ArfFamilyWifiManager<Policy>::m_statistics),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("PowerChange",
+                     "The transmission power has changed",
+                     MakeTraceSourceAccessor (&ArfFamilyWifiManager<Policy>::m_powerChange),
+                     "ns3::WifiRemoteStationManager::PowerChangeTracedCallback")
+    .AddTraceSource ("RateChange",
+                     "The transmission rate of a station has changed",
+                     MakeTraceSourceAccessor (&ArfFamilyWifiManager<Policy>::m_rateChange),
+                     "ns3::WifiRemoteStationManager::RateChangeTracedCallback")
+  ;
+  return tid;
+}
+
+//Constructor
+template <class Policy>
+ArfFamilyWifiManager<Policy>::ArfFamilyWifiManager ()
+  : WifiRemoteStationManager (),
+    m_currentRate (0),
+    m_compactState (false),
+    m_channelWidthAdaptation (false),
+    m_rtsRateAdaptation (false),
+    m_powerControl (false),
+    m_maxPowerLevel (0),
+    m_stagedFallback (false),
+    m_timeBasedTimer (false),
+    m_goodputLadder (false),
+    m_snrAided (false),
+    m_snrMarginRatio (1),
+    m_fastStart (false),
+    m_lossWindowMode (false),
+    m_collisionAwareRts (false),
+    m_rtsModesValid (false),
+    m_rateMemorySize (0),
+    m_statistics (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_compactStationPool = new ArfFamilyStationPool (sizeof (ArfFamilyCompactStation), alignof (ArfFamilyCompactStation));
+  m_fullStationPool = new ArfFamilyStationPool (sizeof (ArfFamilyFullStation), alignof (ArfFamilyFullStation));
+  m_extensionPool = new ArfFamilyStationPool (sizeof (ArfFamilyStationExtension), alignof (ArfFamilyStationExtension));
+  m_statsPool = new ArfFamilyStationPool (sizeof (ArfFamilyStatsRecord), alignof (ArfFamilyStatsRecord));
+  m_statsRecords = new (m_statsPool) ArfFamilyStatsRecord ();
+}
+
+//Destructor
+template <class Policy>
+ArfFamilyWifiManager<Policy>::~ArfFamilyWifiManager ()
+{
+  NS_LOG_FUNCTION (this);
+  //the records of the stations the base class still holds must not unlink
+  //themselves from the list once it is gone
+  while (m_statsRecords->m_next != m_statsRecords)
+    {
+      m_statsRecords->m_next->Unlink ();
+    }
+  delete m_statsRecords;
+  //the pools go away with their last station if the base class still holds some
+  m_compactStationPool->Release ();
+  m_fullStationPool->Release ();
+  m_extensionPool->Release ();
+  m_statsPool->Release ();
+}
+
+/*SetupPhy keeps the highest power level of the PHY, which is the power used at the
+rate positions of the ladder when power control is enabled.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::SetupPhy (const Ptr<WifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  m_maxPowerLevel = (phy->GetNTxPower () > 0) ? phy->GetNTxPower () - 1 : 0;
+  WifiRemoteStationManager::SetupPhy (phy);
+}
+
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_statsEvent.Cancel ();
+  m_statsStream = 0;
+  WifiRemoteStationManager::DoDispose ();
+}
+
+/*DoCreateStation is initializing the member variables of class ArfFamilyWifiRemoteStation*/
+template <class Policy>
+WifiRemoteStation *
+ArfFamilyWifiManager<Policy>::DoCreateStation (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ArfFamilyWifiRemoteStation *station;
+  if (m_compactState)
+    {
+      CheckCompactThresholds ();
+      ArfFamilyCompactStation *compact = new (m_compactStationPool) ArfFamilyCompactStation ();
+      this->InitState (compact->m_arf);
+      station = compact;
+    }
+  else
+    {
+      ArfFamilyFullStation *full = new (m_fullStationPool) ArfFamilyFullStation ();
+      this->InitState (full->m_arf);
+      station = full;
+    }
+  station->m_ladder = 0;
+  station->m_txVectorValid = false;
+  station->m_tracedDataRate = 0;
+  if (HasExtensionModes ())
+    {
+      GetExtension (station);
+    }
+
+  return station;
+}
+
+/*CheckCompactThresholds is called for every new compact station, since the attributes
+can change between stations. Thresholds that do not fit the compact state would
+silently saturate and change the behaviour of the algorithm.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::CheckCompactThresholds (void) const
+{
+  if (this->GetLargestSuccessThreshold () > 0xff)
+    {
+      NS_FATAL_ERROR ("CompactStationState limits the success threshold to 255, got "
+                      << this->GetLargestSuccessThreshold ());
+    }
+  if (this->GetLargestTimerThreshold () > 0xffff)
+    {
+      NS_FATAL_ERROR ("CompactStationState limits the timer threshold to 65535, got "
+                      << this->GetLargestTimerThreshold ());
+    }
+}
+
+/*GetExtension returns the state of the optional modes of the station,
+ allocating it on first use so that the stations of a manager without any
+ of these modes enabled stay small*/
+template <class Policy>
+ArfFamilyStationExtension *
+ArfFamilyWifiManager<Policy>::GetExtension (ArfFamilyWifiRemoteStation *station) const
+{
+  if (station->m_extension == 0)
+    {
+      ArfFamilyStationExtension *extension = new (m_extensionPool) ArfFamilyStationExtension ();
+      GetRtsRateControl ().InitState (extension->m_rtsState);
+      extension->m_timerStart = Simulator::Now ();
+      extension->m_rememberedTime = Seconds (0);
+      extension->m_snr = 0;
+      extension->m_fastStartSnr = 0;
+      extension->m_stats = 0;
+      extension->m_lossWindow.Reset (0);
+      extension->m_protectionSuccess = 0;
+      extension->m_stagedRate = 0;
+      extension->m_stagedAttempt = 0;
+      extension->m_holdOff = 0;
+      extension->m_rememberedRate = ArfFamilyState::MAX_RATES;
+      extension->m_powerLevel = m_powerControl ? m_maxPowerLevel : GetDefaultTxPowerLevel ();
+      extension->m_protection = false;
+      extension->m_rtsUsed = false;
+      extension->m_snrValid = false;
+      extension->m_fastStartDone = false;
+      extension->m_restoreTried = false;
+      station->m_extension = extension;
+    }
+  return station->m_extension;
+}
+
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetHoldOff (const ArfFamilyWifiRemoteStation *station) const
+{
+  return (station->m_extension != 0) ? station->m_extension->m_holdOff : 0;
+}
+
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::HasExtensionModes (void) const
+{
+  return m_rtsRateAdaptation || m_collisionAwareRts || m_powerControl || m_stagedFallback
+         || m_timeBasedTimer || m_snrAided || m_fastStart || m_lossWindowMode
+         || m_rateMemorySize > 0 || m_finalFailureHoldOff > 0 || m_statistics;
+}
+
+/*DoReportRtsFailed is called in the event of RTS failure. It logs the information
+ in case of a RTS failure and, if RTS rate adaptation is enabled, feeds the failure
+ to the RTS rate controller of the station*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportRtsFailed (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+  if (m_rtsRateAdaptation)
+    {
+      GetRtsRateControl ().UpdateOnDataFailed (GetExtension (station)->m_rtsState);
+    }
+  if (m_collisionAwareRts)
+    {
+      //a lost RTS is contention, not a channel error: keep the protection on longer
+      GetExtension (station)->m_protectionSuccess = 0;
+    }
+}
+/**
+ * It is important to realize that "recovery" mode starts after failure of
+ * the first transmission after a rate increase and ends at the first successful
+ * transmission. Specifically, recovery mode transcends retransmissions boundaries.
+ * Fundamentally, ARF handles each data transmission independently, whether it
+ * is the initial transmission of a packet or the retransmission of a packet.
+ * The fundamental reason for this is that there is a backoff between each data
+ * transmission, be it an initial transmission or a retransmission.
+ *
+ * \param st the station that we failed to send DATA
+ */
+
+/*DoReportDataFailed is called in the even of data transmission sucess.
+First it updates transmission statistics variables like m_failed, m_success, etc.
+If Recovery mode is enabled (or member variable m_recovery is true) then
+it checks if number of retries are greater than 1, then it decrements data rate
+to lower available data rate, if it exists and lets the policy update the thresholds
+(AARF multiplies them). If not in recovery mode, it does normal fallback, i.e. only
+on 2 consecutive data packet failures, it will decrement data rate to a lower
+available data rate, if it exists, and lets the policy reset the thresholds. */
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportDataFailed (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  bool rtsUsed = TakeRtsUsed ((ArfFamilyWifiRemoteStation *) st);
+  RecordOutcome ((ArfFamilyWifiRemoteStation *) st, 0, 1);
+  if (m_stagedFallback)
+    {
+      ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+      uint32_t stage = GetStagedFallbackStage (station);
+      GetExtension (station)->m_stagedAttempt++;
+      if (stage != 0)
+        {
+          //a fallback stage failed: the current rate was already judged
+          return;
+        }
+    }
+  if (IsPossibleCollision ((ArfFamilyWifiRemoteStation *) st, rtsUsed))
+    {
+      return;
+    }
+  bool fallback;
+  if (m_lossWindowMode)
+    {
+      fallback = UpdateLossWindow ((ArfFamilyWifiRemoteStation *) st, 0, 1, 0);
+    }
+  else
+    {
+      fallback = ApplyToState ((ArfFamilyWifiRemoteStation *) st, ArfStateDataFailed<Policy> (*this));
+    }
+  CheckTimerReset ((ArfFamilyWifiRemoteStation *) st);
+  if (fallback)
+    {
+      NS_LOG_DEBUG ("station=" << st << " dec rate");
+    }
+  CheckSnrJump ((ArfFamilyWifiRemoteStation *) st, false);
+  RecordTransition ((ArfFamilyWifiRemoteStation *) st);
+}
+
+/* DoReportRxOk function is called in the event of a successful data packet
+reception at the receiving station. It logs the remote station name, related SNR
+and its transmission mode, and feeds the SNR to the SNR average of the station.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportRxOk (WifiRemoteStation *station,
+                                            double rxSnr, WifiMode txMode)
+{
+  NS_LOG_FUNCTION (this << station << rxSnr << txMode);
+  CheckFastStart ((ArfFamilyWifiRemoteStation *) station, rxSnr);
+  UpdateSnr ((ArfFamilyWifiRemoteStation *) station, rxSnr);
+  RecordTransition ((ArfFamilyWifiRemoteStation *) station);
+}
+
+/* DoReportRtsOk function is called in the event of a successful Rts packet
+reception. This function logs the remote station name, SNR of cts packet, cts
+transmission mode and SNR of rts packet, records that the next data frame is
+protected for the collision-aware mode and, if RTS rate adaptation is enabled,
+feeds the success to the RTS rate controller of the station.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportRtsOk (WifiRemoteStation *st,
+                                             double ctsSnr, WifiMode ctsMode, double rtsSnr)
+{
+  NS_LOG_FUNCTION (this << st << ctsSnr << ctsMode << rtsSnr);
+  NS_LOG_DEBUG ("station=" << st << " rts ok");
+  if (m_collisionAwareRts)
+    {
+      //the data frame that follows is protected, whatever decided to protect it
+      GetExtension ((ArfFamilyWifiRemoteStation *) st)->m_rtsUsed = true;
+    }
+  if (m_rtsRateAdaptation)
+    {
+      ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+      CheckRtsModes ();
+      GetRtsRateControl ().UpdateOnDataOk (GetExtension (station)->m_rtsState, m_rtsModes.size ());
+    }
+}
+
+/*DoReportDataOk function is  called in the event of a successful ACK packet
+reception at sender side. First it updates tansmission statistics like m_failed,
+m_success, etc. If number of successful packets tranmitted equals N, or timer
+value reaches N, then rate is incremented to a higher available rate, if it exists
+and recovery mode is turned on. If switched to a new rate, reset member variables 
+m_success and m_timer so that they can contain statistics of new data rate
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportDataOk (WifiRemoteStation *st,
+                                              double ackSnr, WifiMode ackMode, double dataSnr)
+{
+  NS_LOG_FUNCTION (this << st << ackSnr << ackMode << dataSnr);
+  ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+  if (station->m_ladder == 0)
+    {
+      CheckLadder (station);
+    }
+  TakeRtsUsed (station);
+  RecordOutcome (station, 1, 0);
+  if (m_stagedFallback)
+    {
+      uint32_t stage = GetStagedFallbackStage (station);
+      GetExtension (station)->m_stagedAttempt = 0;
+      if (stage != 0)
+        {
+          //success of a fallback stage: the current rate already failed its tries
+          return;
+        }
+    }
+  CountProtectedSuccess (station);
+  bool holdOff = GetHoldOff (station) > 0;
+  uint32_t nRates = GetNRatesAfterSuccess (station);
+  bool increase;
+  if (m_lossWindowMode)
+    {
+      increase = UpdateLossWindow (station, 1, 0, nRates);
+    }
+  else if (m_timeBasedTimer)
+    {
+      increase = ApplyToState (station, ArfStateDataOk<Policy> (*this, nRates, IsTimerExpired (station)));
+      CheckTimerReset (station);
+    }
+  else
+    {
+      increase = ApplyToState (station, ArfStateDataOk<Policy> (*this, nRates));
+    }
+  if (holdOff)
+    {
+      StopHoldOffTimer (station);
+    }
+  if (increase)
+    {
+      NS_LOG_DEBUG ("station=" << station << " inc rate");
+    }
+  //the SNR of the data frame at the station is the one that matters, if known
+  CheckFastStart (station, dataSnr > 0 ? dataSnr : ackSnr);
+  UpdateSnr (station, dataSnr > 0 ? dataSnr : ackSnr);
+  CheckSnrJump (station, true);
+  CheckRateMemory (station);
+  RecordTransition (station);
+}
+
+/*DoReportAmpduTxStatus is called once per Block Ack with the outcome of all the
+MPDUs of an aggregate. The aggregate is handled as a single transmission by
+ArfFamilyRateControl::UpdateOnAggregate instead of replaying one DoReportDataOk or
+DoReportDataFailed per MPDU, which would skew the ARF counters. The optional modes
+judge the aggregate with the same rule as the state machine
+(ArfFamilyRateControl::IsAggregateFailed), except the staged fallback, which follows
+the retransmissions of the MAC.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportAmpduTxStatus (WifiRemoteStation *st,
+                                                     uint8_t nSuccessfulMpdus, uint8_t nFailedMpdus,
+                                                     double rxSnr, double dataSnr)
+{
+  NS_LOG_FUNCTION (this << st << +nSuccessfulMpdus << +nFailedMpdus << rxSnr << dataSnr);
+  ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+  if (station->m_ladder == 0)
+    {
+      CheckLadder (station);
+    }
+  bool rtsUsed = TakeRtsUsed (station);
+  RecordOutcome (station, nSuccessfulMpdus, nFailedMpdus);
+  if (m_stagedFallback)
+    {
+      //the Block Ack ends one attempt of the aggregate
+      uint32_t stage = GetStagedFallbackStage (station);
+      ArfFamilyStationExtension *extension = GetExtension (station);
+      extension->m_stagedAttempt = (nSuccessfulMpdus == 0) * (extension->m_stagedAttempt + 1);
+      if (stage != 0)
+        {
+          return;
+        }
+    }
+  bool failed = this->IsAggregateFailed (nSuccessfulMpdus, nFailedMpdus);
+  if (failed)
+    {
+      if (IsPossibleCollision (station, rtsUsed))
+        {
+          return;
+        }
+    }
+  else
+    {
+      CountProtectedSuccess (station);
+    }
+  bool holdOff = !failed && GetHoldOff (station) > 0;
+  uint32_t nRates = failed ? GetNRates (station) : GetNRatesAfterSuccess (station);
+  bool changed;
+  if (m_lossWindowMode)
+    {
+      changed = UpdateLossWindow (station, nSuccessfulMpdus, nFailedMpdus, nRates);
+    }
+  else if (m_timeBasedTimer)
+    {
+      changed = ApplyToState (station, ArfStateAggregate<Policy> (*this, nSuccessfulMpdus, nFailedMpdus, nRates,
+                                                                  IsTimerExpired (station)));
+      CheckTimerReset (station);
+    }
+  else
+    {
+      changed = ApplyToState (station, ArfStateAggregate<Policy> (*this, nSuccessfulMpdus, nFailedMpdus, nRates));
+    }
+  if (holdOff)
+    {
+      StopHoldOffTimer (station);
+    }
+  if (changed)
+    {
+      NS_LOG_DEBUG ("station=" << station << " rate changed after aggregate");
+    }
+  CheckFastStart (station, dataSnr > 0 ? dataSnr : rxSnr);
+  UpdateSnr (station, dataSnr > 0 ? dataSnr : rxSnr);
+  CheckSnrJump (station, !failed);
+  if (!failed)
+    {
+      CheckRateMemory (station);
+    }
+  RecordTransition (station);
+}
+
+/*DoNeedRts adds RTS/CTS protection on top of the normal decision while the
+collision-aware mode keeps it on for the station. It does not record the decision:
+the base class protects HT and ERP frames itself without calling it, so whether
+a frame was protected is taken from DoReportRtsOk instead.
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::DoNeedRts (WifiRemoteStation *st,
+                                         Ptr<const Packet> packet, bool normally)
+{
+  NS_LOG_FUNCTION (this << st << packet << normally);
+  if (!m_collisionAwareRts)
+    {
+      return normally;
+    }
+  return normally || GetExtension ((ArfFamilyWifiRemoteStation *) st)->m_protection;
+}
+
+/*DoNeedDataRetransmission stops the retransmissions of a packet once its retry
+stages are exhausted in staged fallback mode.
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::DoNeedDataRetransmission (WifiRemoteStation *st,
+                                                        Ptr<const Packet> packet, bool normally)
+{
+  NS_LOG_FUNCTION (this << st << packet << normally);
+  if (!m_stagedFallback)
+    {
+      return normally;
+    }
+  return normally && GetStagedFallbackStage ((ArfFamilyWifiRemoteStation *) st) < 3;
+}
+
+/*IsPossibleCollision implements the collision-aware mode (CARA). A failure without
+RTS/CTS protection may be a collision rather than a channel error, so instead of
+falling back, protection is turned on for the station. Only failures of protected
+frames, whether protected by this mode, by the RtsCtsThreshold or by HT or ERP
+protection, reach the ARF state machine.
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::IsPossibleCollision (ArfFamilyWifiRemoteStation *station, bool rtsUsed)
+{
+  if (!m_collisionAwareRts || rtsUsed)
+    {
+      return false;
+    }
+  ArfFamilyStationExtension *extension = GetExtension (station);
+  NS_LOG_DEBUG ("station=" << station << " failure without protection, enable RTS/CTS");
+  extension->m_protection = true;
+  extension->m_protectionSuccess = 0;
+  return true;
+}
+
+/*TakeRtsUsed tells whether a CTS was received for the data frame whose outcome
+is being reported and clears the flag for the next frame, so that a frame sent
+without RTS never inherits the protection of the previous one.
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::TakeRtsUsed (ArfFamilyWifiRemoteStation *station) const
+{
+  ArfFamilyStationExtension *extension = station->m_extension;
+  if (extension == 0)
+    {
+      return false;
+    }
+  bool rtsUsed = extension->m_rtsUsed;
+  extension->m_rtsUsed = false;
+  return rtsUsed;
+}
+
+/*CountProtectedSuccess turns RTS/CTS protection off again after a streak of
+ProtectionSuccessThreshold successful protected transmissions.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::CountProtectedSuccess (ArfFamilyWifiRemoteStation *station)
+{
+  ArfFamilyStationExtension *extension = station->m_extension;
+  if (extension == 0 || !extension->m_protection)
+    {
+      return;
+    }
+  extension->m_protectionSuccess++;
+  if (extension->m_protectionSuccess >= m_protectionSuccessThreshold)
+    {
+      NS_LOG_DEBUG ("station=" << station << " disable RTS/CTS");
+      extension->m_protection = false;
+    }
+}
+
+/*UpdateSnr keeps an exponentially weighted moving average of the SNRs reported
+for the station. The first report initializes it.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::UpdateSnr (ArfFamilyWifiRemoteStation *station, double snr) const
+{
+  if (!m_snrAided || snr <= 0)
+    {
+      return;
+    }
+  ArfFamilyStationExtension *extension = GetExtension (station);
+  if (extension->m_snrValid)
+    {
+      extension->m_snr += m_snrAlpha * (snr - extension->m_snr);
+    }
+  else
+    {
+      extension->m_snr = snr;
+      extension->m_snrValid = true;
+    }
+}
+
+/*GetSnrTarget looks for the fastest rate of the ladder whose SNR threshold, plus the
+margin, is below the given SNR.
+*/
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetSnrTarget (const ArfFamilyWifiRemoteStation *station, double snr) const
+{
+  snr /= m_snrMarginRatio;
+  uint32_t target = GetLadderIndex (station, GetNRates (station) - 1);
+  while (target > 0 && station->m_ladder->m_entries[target].m_snrThreshold > snr)
+    {
+      target--;
+    }
+  return target;
+}
+
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::SetSnrMargin (double margin)
+{
+  m_snrMargin = margin;
+  m_snrMarginRatio = std::pow (10.0, margin / 10.0);
+}
+
+template <class Policy>
+double
+ArfFamilyWifiManager<Policy>::GetSnrMargin (void) const
+{
+  return m_snrMargin;
+}
+
+/*CheckSnrJump looks for the fastest rate the SNR average of the station supports
+(see GetSnrTarget). If that rate is at least two steps away from the current one, the station
+jumps to it directly instead of walking the ladder one success threshold at a time.
+After a failure the station may only jump down: the average is not fed by failures,
+so during a fade it would send the station straight back to the failing rate.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::CheckSnrJump (ArfFamilyWifiRemoteStation *station, bool success)
+{
+  ArfFamilyStationExtension *extension = station->m_extension;
+  if (!m_snrAided || extension == 0 || !extension->m_snrValid || station->m_ladder == 0)
+    {
+      return;
+    }
+  uint32_t target = GetSnrTarget (station, extension->m_snr);
+  uint32_t rate = GetRate (station);
+  uint32_t index = GetLadderIndex (station, rate);
+  if ((target + 1 >= index && target <= index + 1)
+      || (target > index && (extension->m_holdOff > 0 || !success)))
+    {
+      //power positions above the fastest rate are left to the state machine
+      return;
+    }
+  NS_LOG_DEBUG ("station=" << station << " snr jump from rate " << rate << " to " << target);
+  ApplyToState (station, ArfStateJumpToRate<Policy> (*this, target));
+  CheckTimerReset (station);
+}
+
+/*CheckFastStart seeds the rate of a new station from the first SNR reported for it,
+with the FastStartSnrTable if set and from the SNR thresholds of the ladder otherwise.
+The seeded rate is entered as a probe (recovery mode), so that a failure of the first
+transmission falls back right away as after any rate increase.
+The first SNR usually comes with a management frame, before the capabilities of the
+peer are known: it is kept, and the rate is only seeded once the ladder is built from
+the final supported set, at the latest when the first data frame is sent.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::CheckFastStart (ArfFamilyWifiRemoteStation *station, double snr)
+{
+  if (!m_fastStart)
+    {
+      return;
+    }
+  ArfFamilyStationExtension *extension = GetExtension (station);
+  if (extension->m_fastStartDone)
+    {
+      return;
+    }
+  if (extension->m_fastStartSnr <= 0)
+    {
+      extension->m_fastStartSnr = snr;
+    }
+  snr = extension->m_fastStartSnr;
+  if (snr <= 0)
+    {
+      return;
+    }
+  CheckLadder (station);
+  if (extension->m_fastStartDone || IsProvisionalLadder (station))
+    {
+      //the first final ladder may have restored a remembered rate, which wins
+      return;
+    }
+  extension->m_fastStartDone = true;
+  uint32_t target = 0;
+  ParseFastStartTable ();
+  if (m_fastStartTable.empty ())
+    {
+      target = GetSnrTarget (station, snr);
+    }
+  else
+    {
+      for (std::vector<std::pair<double, uint32_t> >::const_iterator i = m_fastStartTable.begin ();
+           i != m_fastStartTable.end () && i->first <= snr; i++)
+        {
+          target = i->second;
+        }
+      target = GetLadderIndex (station, target);
+    }
+  NS_LOG_DEBUG ("station=" << station << " fast start at rate " << target << " for snr " << snr);
+  if (ApplyToState (station, ArfStateJumpToRate<Policy> (*this, target)))
+    {
+      CheckTimerReset (station);
+    }
+}
+
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::IsProvisionalLadder (const ArfFamilyWifiRemoteStation *station) const
+{
+  return station->m_ladder->m_nSupported <= 1 && station->m_ladder->m_nMcsSupported <= 1;
+}
+
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::ParseFastStartTable (void)
+{
+  if (m_fastStartTableParsed == m_fastStartTableString)
+    {
+      return;
+    }
+  m_fastStartTableParsed = m_fastStartTableString;
+  m_fastStartTable.clear ();
+  std::istringstream iss (m_fastStartTableString);
+  std::string pair;
+  while (std::getline (iss, pair, ','))
+    {
+      double snrDb;
+      uint32_t index;
+      char separator;
+      std::istringstream pairStream (pair);
+      if (!(pairStream >> snrDb >> separator >> index) || separator != ':')
+        {
+          NS_FATAL_ERROR ("Invalid FastStartSnrTable entry \"" << pair << "\"");
+        }
+      m_fastStartTable.push_back (std::make_pair (std::pow (10.0, snrDb / 10.0), index));
+    }
+  std::sort (m_fastStartTable.begin (), m_fastStartTable.end ());
+}
+
+/*CheckRateMemory records the operating point of the station once a transmission
+succeeded at a new rate, rather than when the rate changes, so that an unconfirmed
+probe is never remembered. Since stations are deleted by the base class without
+notice, the record is also refreshed when it reaches half its lifetime. This keeps
+the map lookups off the per-packet path. Nothing is recorded while the ladder of the
+station is provisional, which would replace the entry of a returning peer before its
+rates are known.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::CheckRateMemory (ArfFamilyWifiRemoteStation *station)
+{
+  if (m_rateMemorySize == 0 || IsProvisionalLadder (station))
+    {
+      return;
+    }
+  ArfRateMemoryEntry entry;
+  bool recovery = ApplyToState (station, ArfStateGetEntry (entry));
+  uint32_t rate = entry.m_rate;
+  Time now = Simulator::Now ();
+  ArfFamilyStationExtension *extension = GetExtension (station);
+  if ((recovery && !m_lossWindowMode)
+      || (rate == extension->m_rememberedRate
+          && (now - extension->m_rememberedTime).GetSeconds () * 2 < m_rateMemoryLifetime.GetSeconds ()))
+    {
+      return;
+    }
+  extension->m_rememberedRate = rate;
+  extension->m_rememberedTime = now;
+  entry.m_address = GetAddress (station);
+  entry.m_ladder = station->m_ladder;
+  entry.m_lastUpdate = now;
+  typename std::map<Mac48Address, std::list<ArfRateMemoryEntry>::iterator>::iterator it = m_rateMemoryIndex.find (entry.m_address);
+  if (it != m_rateMemoryIndex.end ())
+    {
+      m_rateMemory.erase (it->second);
+    }
+  else if (m_rateMemory.size () >= m_rateMemorySize)
+    {
+      m_rateMemoryIndex.erase (m_rateMemory.back ().m_address);
+      m_rateMemory.pop_back ();
+    }
+  m_rateMemory.push_front (entry);
+  m_rateMemoryIndex[entry.m_address] = m_rateMemory.begin ();
+}
+
+/*RestoreRate gives a new station the rate and thresholds remembered for its address,
+if the entry is recent enough and was recorded with the same ladder (a peer coming
+back with other capabilities starts from scratch). A restored station skips the fast
+start. CheckLadder calls it once per station, on the first ladder built from more than
+the default mode: the first ladder of a station is often built before the capabilities
+of the peer are known, and could never match the entry.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::RestoreRate (ArfFamilyWifiRemoteStation *station)
+{
+  if (m_rateMemorySize == 0)
+    {
+      return;
+    }
+  typename std::map<Mac48Address, std::list<ArfRateMemoryEntry>::iterator>::iterator it = m_rateMemoryIndex.find (GetAddress (station));
+  if (it == m_rateMemoryIndex.end ())
+    {
+      return;
+    }
+  const ArfRateMemoryEntry &entry = *it->second;
+  if (Simulator::Now () - entry.m_lastUpdate > m_rateMemoryLifetime)
+    {
+      m_rateMemory.erase (it->second);
+      m_rateMemoryIndex.erase (it);
+      return;
+    }
+  if (entry.m_ladder != station->m_ladder || entry.m_rate >= GetNRates (station))
+    {
+      return;
+    }
+  NS_LOG_DEBUG ("station=" << station << " resumes at rate " << entry.m_rate);
+  ApplyToState (station, ArfStateSetEntry (entry));
+  ArfFamilyStationExtension *extension = GetExtension (station);
+  extension->m_rememberedRate = entry.m_rate;
+  extension->m_rememberedTime = entry.m_lastUpdate;
+  extension->m_fastStartDone = true;
+  m_rateMemory.splice (m_rateMemory.begin (), m_rateMemory, it->second);
+}
+
+/*UpdateLossWindow implements the loss window mode. The window restarts whenever
+the rate changes, whatever changed it. The rate goes down as soon as the losses
+reach the lower threshold, without waiting for the window to be full, and only goes
+up on a full window whose loss ratio is at most the raise threshold.
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::UpdateLossWindow (ArfFamilyWifiRemoteStation *station, uint32_t nSuccess, uint32_t nFailed,
+                                                uint32_t nRates)
+{
+  if (station->m_ladder == 0)
+    {
+      CheckLadder (station);
+    }
+  uint32_t rate = GetRate (station);
+  ArfLossWindow &window = GetExtension (station)->m_lossWindow;
+  if (window.m_rate != rate)
+    {
+      window.Reset (rate);
+    }
+  window.Add (nSuccess, nFailed, m_lossWindowSize);
+  uint32_t nLosses = window.GetNLosses ();
+  if (rate > 0 && nLosses > 0 && nLosses >= m_lossWindowLowerThreshold * m_lossWindowSize)
+    {
+      rate--;
+    }
+  else if (window.m_count == m_lossWindowSize
+           && nLosses <= m_lossWindowRaiseThreshold * m_lossWindowSize
+           && rate + 1 < nRates)
+    {
+      rate++;
+    }
+  else
+    {
+      return false;
+    }
+  NS_LOG_DEBUG ("station=" << station << " " << nLosses << " losses in window, rate " << rate);
+  SetRate (station, rate);
+  window.Reset (rate);
+  return true;
+}
+
+/*GetNRatesAfterSuccess counts the successes of the hold-off that follows a dropped
+packet. Passing the current rate + 1 as the number of rates to the state machine
+blocks any increase while the success counter keeps running; the timer is held
+by StopHoldOffTimer.
+*/
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetNRatesAfterSuccess (ArfFamilyWifiRemoteStation *station)
+{
+  ArfFamilyStationExtension *extension = station->m_extension;
+  if (extension != 0 && extension->m_holdOff > 0)
+    {
+      extension->m_holdOff--;
+      return GetRate (station) + 1;
+    }
+  return GetNRates (station);
+}
+
+/*StopHoldOffTimer keeps the timer of a station in hold-off at 0. Left running, it
+would pass the timer timeout while increases are blocked, and the state machine only
+fires the timer when it is equal to the timeout: timer-driven probing would then be
+lost until a failure resets the timer.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::StopHoldOffTimer (ArfFamilyWifiRemoteStation *station) const
+{
+  ApplyToState (station, ArfStateResetTimer ());
+  CheckTimerReset (station);
+}
+
+/*GetStagedFallbackStage maps the number of attempts already made for the current packet
+to a fallback stage: 0 for the first rate of the packet, 1 for the next lower rate and
+2 for the lowest rate. Stages with no tries are skipped.
+*/
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetStagedFallbackStage (ArfFamilyWifiRemoteStation *station) const
+{
+  uint32_t attempt = GetExtension (station)->m_stagedAttempt;
+  if (attempt < m_stagedFallbackCurrentTries)
+    {
+      return 0;
+    }
+  attempt -= m_stagedFallbackCurrentTries;
+  if (attempt < m_stagedFallbackLowerTries)
+    {
+      return 1;
+    }
+  attempt -= m_stagedFallbackLowerTries;
+  if (attempt < m_stagedFallbackLowestTries)
+    {
+      return 2;
+    }
+  return 3;
+}
+
+/*GetStagedFallbackRate fixes the stages of a packet at its first attempt from the rate of
+the state machine, so that a fallback decided while the packet is retried only applies
+to the next packet. It is called by
+DoGetDataTxVector right before each attempt, so m_stagedAttempt is the number of
+attempts already made for the packet being sent.
+*/
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetStagedFallbackRate (ArfFamilyWifiRemoteStation *station)
+{
+  ArfFamilyStationExtension *extension = GetExtension (station);
+  if (extension->m_stagedAttempt == 0 || extension->m_stagedRate >= GetNRates (station))
+    {
+      extension->m_stagedRate = GetRate (station);
+    }
+  switch (GetStagedFallbackStage (station))
+    {
+    case 0:
+      return extension->m_stagedRate;
+    case 1:
+      return (extension->m_stagedRate > 0) ? extension->m_stagedRate - 1 : 0;
+    default:
+      return 0;
+    }
+}
+
+/*IsTimerExpired compares the time elapsed since the last timer reset with the probe
+interval, scaled by the current timer threshold of the station over its initial value
+(the ratio is 1 for ARF, AARF multiplies the threshold after failed probes).
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::IsTimerExpired (ArfFamilyWifiRemoteStation *station) const
+{
+  uint32_t timerTimeout = this->GetTimerTimeout (ApplyToState (station, ArfStateGetTimerTimeout ()));
+  double elapsed = (Simulator::Now () - GetExtension (station)->m_timerStart).GetSeconds ();
+  return elapsed * std::max<uint32_t> (this->GetInitialTimerTimeout (), 1)
+         >= m_probeInterval.GetSeconds () * timerTimeout;
+}
+
+/*CheckTimerReset restarts the time-based timer when the state machine reset its
+packet count, which it does on every rate change and on the failures that reset the
+ARF timer.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::CheckTimerReset (ArfFamilyWifiRemoteStation *station) const
+{
+  if (!m_timeBasedTimer)
+    {
+      return;
+    }
+  if (ApplyToState (station, ArfStateGetTimer ()) == 0)
+    {
+      GetExtension (station)->m_timerStart = Simulator::Now ();
+    }
+}
+
+/*GetStats returns the statistics of a station, allocating them on first use. They
+are owned by the extension of the station and linked into the list of the manager,
+which prints them.
+*/
+template <class Policy>
+ArfFamilyStationStats *
+ArfFamilyWifiManager<Policy>::GetStats (ArfFamilyWifiRemoteStation *station)
+{
+  if (!m_statistics)
+    {
+      return 0;
+    }
+  ArfFamilyStationExtension *extension = GetExtension (station);
+  if (extension->m_stats == 0)
+    {
+      ArfFamilyStatsRecord *record = new (m_statsPool) ArfFamilyStatsRecord ();
+      record->m_stats.Reset (GetRate (station), Simulator::Now ());
+      record->m_address = GetAddress (station);
+      record->m_tid = station->m_tid;
+      record->Link (m_statsRecords);
+      extension->m_stats = record;
+    }
+  return &extension->m_stats->m_stats;
+}
+
+/*RecordOutcome counts the frames sent at the rate index of the last data tx vector
+of the station and, when a packet or an aggregate gets through, the number of
+retries it took.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::RecordOutcome (ArfFamilyWifiRemoteStation *station, uint32_t nSuccess, uint32_t nFailed)
+{
+  ArfFamilyStationStats *stats = GetStats (station);
+  if (stats == 0)
+    {
+      return;
+    }
+  uint32_t rate = station->m_txVectorValid ? station->m_txVectorRate : 0;
+  stats->m_framesAtRate[ArfFamilyStationStats::GetRateBucket (rate)] += nSuccess + nFailed;
+  if (nSuccess == 0)
+    {
+      stats->m_attempts++;
+    }
+  else
+    {
+      stats->m_retries[std::min (stats->m_attempts, ArfFamilyStationStats::MAX_RETRIES - 1)]++;
+      stats->m_attempts = 0;
+    }
+}
+
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::RecordTransition (ArfFamilyWifiRemoteStation *station)
+{
+  ArfFamilyStationStats *stats = GetStats (station);
+  if (stats == 0)
+    {
+      return;
+    }
+  ApplyToState (station, ArfStateRecord<Policy> (*this, *stats));
+}
+
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::GetStationStats (Mac48Address address, uint8_t tid, ArfFamilyStationStats &stats) const
+{
+  for (const ArfFamilyStatsRecord *i = m_statsRecords->m_next; i != m_statsRecords; i = i->m_next)
+    {
+      if (i->m_address == address && i->m_tid == tid)
+        {
+          stats = i->m_stats;
+          stats.AccountTime (Simulator::Now ());
+          return true;
+        }
+    }
+  return false;
+}
+
+/*PrintStationStats prints one line per station, in the order they were first counted:
+the current rate index, thresholds and counters, then the time (s) and frames at each
+rate index used, as index:time:frames, the overflow bucket being printed as
+MAX_RATES+, and the retry histogram, the last bucket counting the packets that needed
+MAX_RETRIES - 1 retries or more.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::PrintStationStats (std::ostream &os) const
+{
+  for (const ArfFamilyStatsRecord *i = m_statsRecords->m_next; i != m_statsRecords; i = i->m_next)
+    {
+      ArfFamilyStationStats stats = i->m_stats;
+      stats.AccountTime (Simulator::Now ());
+      os << Simulator::Now ().GetSeconds () << " " << i->m_address
+         << " tid=" << +i->m_tid
+         << " rate=" << stats.m_rate
+         << " recovery=" << stats.m_recovery
+         << " successThreshold=" << stats.m_successThreshold
+         << " timerTimeout=" << stats.m_timerTimeout
+         << " up=" << stats.m_nIncreases
+         << " down=" << stats.m_nDecreases
+         << " recoveries=" << stats.m_nRecoveries
+         << " failedProbes=" << stats.m_nFailedProbes
+         << " dropped=" << stats.m_nDropped
+         << " rates=";
+      for (uint32_t j = 0; j <= ArfFamilyStationStats::MAX_RATES; j++)
+        {
+          if (stats.m_framesAtRate[j] > 0 || !stats.m_timeAtRate[j].IsZero ())
+            {
+              os << j << (j == ArfFamilyStationStats::MAX_RATES ? "+" : "") << ":"
+                 << stats.m_timeAtRate[j].GetSeconds () << ":" << stats.m_framesAtRate[j] << ",";
+            }
+        }
+      os << " retries=";
+      for (uint32_t j = 0; j < ArfFamilyStationStats::MAX_RETRIES; j++)
+        {
+          os << (j > 0 ? "," : "") << stats.m_retries[j];
+        }
+      os << std::endl;
+    }
+}
+
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::EnableStationStatsDump (Ptr<OutputStreamWrapper> stream, Time interval)
+{
+  NS_LOG_FUNCTION (this << stream << interval);
+  NS_ASSERT_MSG (m_statistics, "the Statistics attribute must be enabled");
+  NS_ASSERT (interval.IsStrictlyPositive ());
+  m_statsStream = stream;
+  m_statsInterval = interval;
+  m_statsEvent.Cancel ();
+  m_statsEvent = Simulator::Schedule (m_statsInterval, &ArfFamilyWifiManager<Policy>::DumpStationStats, this);
+}
+
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DumpStationStats (void)
+{
+  PrintStationStats (*m_statsStream->GetStream ());
+  m_statsEvent = Simulator::Schedule (m_statsInterval, &ArfFamilyWifiManager<Policy>::DumpStationStats, this);
+}
+
+/*DoReportFinalRtsFailed function is called in the event when the transmission 
+of a RTS has exceeded the maximum number of attempts. The packet is dropped, so the
+next packet starts its staged fallback from the first stage.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportFinalRtsFailed (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+  if (station->m_extension != 0)
+    {
+      station->m_extension->m_stagedAttempt = 0;
+    }
+}
+
+/*DoReportFinalDataFailed unction is called in the event when the  transmission
+ of a data packet has exceeded the maximum number of attempts. If a reaction is
+ configured, the station falls back FinalFailureSteps rates or to FinalFailureFloor,
+ and its thresholds are reset as after a normal fallback, even if the rate is already
+ at or below the target.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::DoReportFinalDataFailed (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+  if (station->m_extension != 0)
+    {
+      station->m_extension->m_stagedAttempt = 0;
+    }
+  ArfFamilyStationStats *stats = GetStats (station);
+  if (stats != 0)
+    {
+      stats->m_nDropped++;
+      stats->m_attempts = 0;
+    }
+  if (m_finalFailureSteps == 0 && m_finalFailureFloor == 0xffffffff && m_finalFailureHoldOff == 0)
+    {
+      return;
+    }
+  uint32_t rate = GetRate (station);
+  uint32_t target = (rate > m_finalFailureSteps) ? rate - m_finalFailureSteps : 0;
+  target = std::min (target, m_finalFailureFloor);
+  target = std::min (target, rate);
+  NS_LOG_DEBUG ("station=" << station << " packet dropped, rate " << rate << " to " << target);
+  ApplyToState (station, ArfStateFallBackTo<Policy> (*this, target));
+  if (m_finalFailureHoldOff > 0)
+    {
+      GetExtension (station)->m_holdOff = m_finalFailureHoldOff;
+    }
+  CheckTimerReset (station);
+  RecordTransition (station);
+}
+
+/*CheckLadder is called before the rate index of a station is used. The ladder is
+built once the supported sets of the station are known and is shared with every other
+station that ends up with the same ladder. It is only rebuilt if the supported sets,
+the channel width or the preamble settings change afterwards.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::CheckLadder (ArfFamilyWifiRemoteStation *station)
+{
+  uint32_t stationChannelWidth = GetChannelWidth (station);
+  bool shortPreamble = GetShortPreambleEnabled ();
+  bool greenfieldProtection = GetUseGreenfieldProtection ();
+  const ArfRateLadder *ladder = station->m_ladder;
+  if (ladder != 0
+      && ladder->m_nSupported == GetNSupported (station)
+      && ladder->m_nMcsSupported == GetNMcsSupported (station)
+      && ladder->m_stationChannelWidth == stationChannelWidth
+      && ladder->m_shortPreamble == shortPreamble
+      && ladder->m_greenfieldProtection == greenfieldProtection)
+    {
+      return;
+    }
+  ArfRateLadder candidate;
+  candidate.m_nSupported = GetNSupported (station);
+  candidate.m_nMcsSupported = GetNMcsSupported (station);
+  candidate.m_stationChannelWidth = stationChannelWidth;
+  candidate.m_shortPreamble = shortPreamble;
+  candidate.m_greenfieldProtection = greenfieldProtection;
+  BuildLadder (station, candidate);
+  if (m_compactState
+      && candidate.m_entries.size () + (m_powerControl ? m_maxPowerLevel : 0) > ArfFamilyCompactState::MAX_RATES)
+    {
+      //e.g. HE with ChannelWidthAdaptation up to 160 MHz and several streams
+      NS_FATAL_ERROR ("CompactStationState limits the ladder to " << ArfFamilyCompactState::MAX_RATES
+                      << " rates, the ladder of " << GetAddress (station) << " has "
+                      << candidate.m_entries.size () << " rates"
+                      << (m_powerControl ? " plus the power levels" : ""));
+    }
+  station->m_ladder = 0;
+  for (std::list<ArfRateLadder>::const_iterator i = m_ladders.begin (); i != m_ladders.end (); i++)
+    {
+      if (i->m_nSupported != candidate.m_nSupported
+          || i->m_nMcsSupported != candidate.m_nMcsSupported
+          || i->m_stationChannelWidth != candidate.m_stationChannelWidth
+          || i->m_shortPreamble != candidate.m_shortPreamble
+          || i->m_greenfieldProtection != candidate.m_greenfieldProtection
+          || i->m_entries.size () != candidate.m_entries.size ())
+        {
+          continue;
+        }
+      bool same = true;
+      for (uint32_t j = 0; j < candidate.m_entries.size () && same; j++)
+        {
+          const ArfRateLadderEntry &a = i->m_entries[j];
+          const ArfRateLadderEntry &b = candidate.m_entries[j];
+          same = a.m_mode == b.m_mode
+            && a.m_nss == b.m_nss
+            && a.m_guardInterval == b.m_guardInterval
+            && a.m_channelWidth == b.m_channelWidth
+            && a.m_preamble == b.m_preamble;
+        }
+      if (same)
+        {
+          station->m_ladder = &(*i);
+          break;
+        }
+    }
+  if (station->m_ladder == 0)
+    {
+      NS_LOG_DEBUG ("new rate ladder with " << candidate.m_entries.size () << " rates");
+      m_ladders.push_back (candidate);
+      station->m_ladder = &m_ladders.back ();
+    }
+  if (GetRate (station) >= GetNRates (station))
+    {
+      SetRate (station, GetNRates (station) - 1);
+    }
+  if (m_rateMemorySize > 0 && !IsProvisionalLadder (station))
+    {
+      ArfFamilyStationExtension *extension = GetExtension (station);
+      if (!extension->m_restoreTried)
+        {
+          extension->m_restoreTried = true;
+          RestoreRate (station);
+        }
+    }
+}
+
+/**
+ * Some VHT MCS are not allowed for some combinations of channel width and
+ * number of spatial streams.
+ *
+ * \param mcs the VHT MCS
+ * \param channelWidth the channel width (MHz)
+ * \param nss the number of spatial streams
+ * \return true if the combination is allowed
+ */
+static bool
+IsAllowedVhtMcs (uint8_t mcs, uint16_t channelWidth, uint8_t nss)
+{
+  if (mcs == 9 && channelWidth == 20 && nss != 3 && nss != 6)
+    {
+      return false;
+    }
+  if (mcs == 6 && channelWidth == 80 && (nss == 3 || nss == 7))
+    {
+      return false;
+    }
+  if (mcs == 9 && channelWidth == 160 && nss == 3)
+    {
+      return false;
+    }
+  return true;
+}
+
+/**
+ * Order ladder entries by data rate.
+ *
+ * \param a the first entry
+ * \param b the second entry
+ * \return true if a is slower than b
+ */
+static bool
+IsSlowerLadderEntry (const ArfRateLadderEntry &a, const ArfRateLadderEntry &b)
+{
+  return a.m_dataRate < b.m_dataRate;
+}
+
+/*BuildLadder picks the MCSs of the best modulation class supported by both this
+device and the station (HE, then VHT, then HT) and falls back to the legacy
+supported set otherwise. Legacy ladders keep the supported set order, unless they
+are sorted by goodput and pruned (GoodputLadder). With channel
+width adaptation, MCS ladders start with the (MCS, nss) pairs of 20 MHz, then only
+hold the pairs of each wider width that are faster than everything below them, up to
+the common width: stepping down the ladder from the top narrows the channel (e.g. 80
+to 40 to 20 MHz) once the slowest pair of the current width fails, and stepping up
+widens it again. Wide entries that a narrower width matches or beats are dropped.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::BuildLadder (const ArfFamilyWifiRemoteStation *station, ArfRateLadder &ladder)
+{
+  WifiModulationClass mcsClass = WIFI_MOD_CLASS_UNKNOWN;
+  if (GetHeSupported () && GetHeSupported (station))
+    {
+      mcsClass = WIFI_MOD_CLASS_HE;
+    }
+  else if (GetVhtSupported () && GetVhtSupported (station))
+    {
+      mcsClass = WIFI_MOD_CLASS_VHT;
+    }
+  else if (GetHtSupported () && GetHtSupported (station))
+    {
+      mcsClass = WIFI_MOD_CLASS_HT;
+    }
+  if (mcsClass != WIFI_MOD_CLASS_UNKNOWN)
+    {
+      uint16_t channelWidth = std::min<uint16_t> (GetChannelWidth (station), GetPhy ()->GetChannelWidth ());
+      if (mcsClass == WIFI_MOD_CLASS_HT)
+        {
+          channelWidth = std::min<uint16_t> (channelWidth, 40);
+        }
+      uint16_t guardInterval;
+      if (mcsClass == WIFI_MOD_CLASS_HE)
+        {
+          guardInterval = std::max (GetGuardInterval (station), static_cast<uint16_t> (GetPhy ()->GetGuardInterval ().GetNanoSeconds ()));
+        }
+      else
+        {
+          guardInterval = (GetShortGuardInterval (station) && GetPhy ()->GetShortGuardInterval ()) ? 400 : 800;
+        }
+      std::vector<uint16_t> channelWidths;
+      if (m_channelWidthAdaptation)
+        {
+          for (uint16_t width = 20; width <= channelWidth; width *= 2)
+            {
+              channelWidths.push_back (width);
+            }
+        }
+      else
+        {
+          channelWidths.push_back (channelWidth);
+        }
+      uint8_t maxNss = std::min (GetNumberOfSupportedStreams (station), GetPhy ()->GetMaxSupportedTxSpatialStreams ());
+      for (std::vector<uint16_t>::const_iterator width = channelWidths.begin (); width != channelWidths.end (); width++)
+        {
+          for (uint32_t i = 0; i < GetNMcsSupported (station); i++)
+            {
+              WifiMode mode = GetMcsSupported (station, i);
+              if (mode.GetModulationClass () != mcsClass)
+                {
+                  continue;
+                }
+              for (uint8_t nss = 1; nss <= maxNss; nss++)
+                {
+                  if (mcsClass == WIFI_MOD_CLASS_HT && nss != (mode.GetMcsValue () / 8) + 1)
+                    {
+                      //HT MCS values already encode the number of streams
+                      continue;
+                    }
+                  if (mcsClass == WIFI_MOD_CLASS_VHT && !IsAllowedVhtMcs (mode.GetMcsValue (), *width, nss))
+                    {
+                      continue;
+                    }
+                  ArfRateLadderEntry entry;
+                  entry.m_mode = mode;
+                  entry.m_nss = nss;
+                  entry.m_guardInterval = guardInterval;
+                  entry.m_channelWidth = *width;
+                  entry.m_dataRate = mode.GetDataRate (*width, guardInterval, nss);
+                  entry.m_preamble = GetPreambleForTransmission (mode, GetAddress (station));
+                  entry.m_snrThreshold = 0;
+                  ladder.m_entries.push_back (entry);
+                }
+            }
+        }
+      if (m_channelWidthAdaptation)
+        {
+          ladder.OrderByWidth ();
+        }
+      else
+        {
+          std::stable_sort (ladder.m_entries.begin (), ladder.m_entries.end (), IsSlowerLadderEntry);
+        }
+    }
+  bool legacy = ladder.m_entries.empty ();
+  if (legacy)
+    {
+      uint16_t channelWidth = GetChannelWidth (station);
+      if (channelWidth > 20 && channelWidth != 22)
+        {
+          //avoid to use legacy rate adaptation algorithms for IEEE 802.11n/ac
+          channelWidth = 20;
+        }
+      for (uint32_t i = 0; i < GetNSupported (station); i++)
+        {
+          ArfRateLadderEntry entry;
+          entry.m_mode = GetSupported (station, i);
+          entry.m_nss = 1;
+          entry.m_guardInterval = 800;
+          entry.m_channelWidth = channelWidth;
+          entry.m_dataRate = entry.m_mode.GetDataRate (channelWidth);
+          entry.m_preamble = GetPreambleForTransmission (entry.m_mode, GetAddress (station));
+          entry.m_snrThreshold = 0;
+          ladder.m_entries.push_back (entry);
+        }
+    }
+  if (m_snrAided || m_fastStart || (legacy && m_goodputLadder))
+    {
+      for (std::vector<ArfRateLadderEntry>::iterator i = ladder.m_entries.begin (); i != ladder.m_entries.end (); i++)
+        {
+          WifiTxVector txVector (i->m_mode, GetDefaultTxPowerLevel (), 0, i->m_preamble,
+                                 i->m_guardInterval, i->m_nss, i->m_nss, 0, i->m_channelWidth, false, false);
+          i->m_snrThreshold = GetPhy ()->CalculateSnr (txVector, m_snrBer);
+        }
+    }
+  if (legacy && m_goodputLadder)
+    {
+      SortLadderByGoodput (ladder);
+    }
+}
+
+/**
+ * Order ladder entries by goodput.
+ *
+ * \param a the first entry and its goodput
+ * \param b the second entry and its goodput
+ * \return true if the goodput of a is lower than the goodput of b
+ */
+static bool
+IsLowerGoodput (const std::pair<double, ArfRateLadderEntry> &a, const std::pair<double, ArfRateLadderEntry> &b)
+{
+  return a.first < b.first;
+}
+
+/*SortLadderByGoodput computes the goodput of each rate from the duration of a
+GoodputFrameSize frame, preamble included, so that e.g. DSSS/CCK 11 Mb/s with a long
+preamble lands below ERP-OFDM 9 Mb/s. Walking down from the fastest rate, a rate is
+only kept if it needs strictly less SNR than every faster rate kept so far: otherwise
+it would never be worth using.
+*/
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::SortLadderByGoodput (ArfRateLadder &ladder) const
+{
+  std::vector<std::pair<double, ArfRateLadderEntry> > entries;
+  for (std::vector<ArfRateLadderEntry>::const_iterator i = ladder.m_entries.begin (); i != ladder.m_entries.end (); i++)
+    {
+      WifiTxVector txVector (i->m_mode, GetDefaultTxPowerLevel (), 0, i->m_preamble,
+                             i->m_guardInterval, i->m_nss, i->m_nss, 0, i->m_channelWidth, false, false);
+      Time duration = GetPhy ()->CalculateTxDuration (m_goodputFrameSize, txVector, GetPhy ()->GetFrequency ());
+      double goodput = (duration.GetSeconds () > 0) ? m_goodputFrameSize * 8 / duration.GetSeconds () : i->m_dataRate;
+      entries.push_back (std::make_pair (goodput, *i));
+    }
+  std::stable_sort (entries.begin (), entries.end (), IsLowerGoodput);
+  ladder.m_entries.clear ();
+  double minSnrThreshold = 0;
+  for (std::vector<std::pair<double, ArfRateLadderEntry> >::const_reverse_iterator i = entries.rbegin (); i != entries.rend (); i++)
+    {
+      if (!ladder.m_entries.empty () && i->second.m_snrThreshold >= minSnrThreshold)
+        {
+          NS_LOG_DEBUG ("rate " << i->second.m_mode << " dominated, left out of the ladder");
+          continue;
+        }
+      minSnrThreshold = i->second.m_snrThreshold;
+      ladder.m_entries.push_back (i->second);
+    }
+  std::reverse (ladder.m_entries.begin (), ladder.m_entries.end ());
+}
+
+/*ApplyToState is the only place that knows which station type holds the state
+machine. Stations are never const objects: the const pointer only saves the const
+callers a cast.
+*/
+template <class Policy>
+template <class Functor>
+typename Functor::Result
+ArfFamilyWifiManager<Policy>::ApplyToState (const ArfFamilyWifiRemoteStation *station, const Functor &f) const
+{
+  ArfFamilyWifiRemoteStation *st = const_cast<ArfFamilyWifiRemoteStation *> (station);
+  if (m_compactState)
+    {
+      return f (static_cast<ArfFamilyCompactStation *> (st)->m_arf);
+    }
+  return f (static_cast<ArfFamilyFullStation *> (st)->m_arf);
+}
+
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetRate (const ArfFamilyWifiRemoteStation *station) const
+{
+  return ApplyToState (station, ArfStateGetRate ());
+}
+
+template <class Policy>
+void
+ArfFamilyWifiManager<Policy>::SetRate (ArfFamilyWifiRemoteStation *station, uint32_t rate) const
+{
+  ApplyToState (station, ArfStateSetRate (rate));
+}
+
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetNRates (const ArfFamilyWifiRemoteStation *station) const
+{
+  uint32_t nRates = station->m_ladder->m_entries.size ();
+  if (m_powerControl)
+    {
+      nRates += m_maxPowerLevel;
+    }
+  return std::min (nRates, ApplyToState (station, ArfStateGetMaxRates ()));
+}
+
+template <class Policy>
+uint32_t
+ArfFamilyWifiManager<Policy>::GetLadderIndex (const ArfFamilyWifiRemoteStation *station, uint32_t rate) const
+{
+  uint32_t last = station->m_ladder->m_entries.size () - 1;
+  return (rate < last) ? rate : last;
+}
+
+template <class Policy>
+uint8_t
+ArfFamilyWifiManager<Policy>::GetPowerLevel (const ArfFamilyWifiRemoteStation *station, uint32_t rate) const
+{
+  if (!m_powerControl)
+    {
+      return GetDefaultTxPowerLevel ();
+    }
+  return m_maxPowerLevel - (rate - GetLadderIndex (station, rate));
+}
+
+/* This function returns Wifi data transmission vector. Wifi data transmission vector
+contains Wifi mode, transmission power level, Retry count, Preamble 
+for sending station, guard interval, nss, nss, 0, channel width, GetAggregation (station),
+false), all taken from the rate ladder entry of the station. The power level is the
+default one, or the one of the ladder position with power control.
+The vector is cached per station and only rebuilt when the rate index, the rate ladder
+or the aggregation setting change, since this is called for every frame. The retry
+count changes with every attempt, so it is set on the cached vector at every call. The RateChange
+trace is only checked on a rebuild, against the data rate of the current rate index of
+the station, so that the stages of a staged fallback are not reported as changes.
+*/
+template <class Policy>
+WifiTxVector
+ArfFamilyWifiManager<Policy>::DoGetDataTxVector (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+  CheckLadder (station);
+  if (m_fastStart)
+    {
+      CheckFastStart (station, 0);
+    }
+  uint32_t rate = m_stagedFallback ? GetStagedFallbackRate (station) : GetRate (station);
+  bool aggregation = GetAggregation (station);
+  if (!station->m_txVectorValid
+      || station->m_txVectorRate != rate
+      || station->m_txVectorLadder != station->m_ladder
+      || station->m_txVectorAggregation != aggregation)
+    {
+      const ArfRateLadderEntry &entry = station->m_ladder->m_entries[GetLadderIndex (station, rate)];
+      uint8_t powerLevel = GetPowerLevel (station, rate);
+      if (m_powerControl)
+        {
+          ArfFamilyStationExtension *extension = GetExtension (station);
+          if (powerLevel != extension->m_powerLevel)
+            {
+              NS_LOG_DEBUG ("station=" << station << " power level " << +powerLevel);
+              m_powerChange (GetPhy ()->GetPowerDbm (extension->m_powerLevel), GetPhy ()->GetPowerDbm (powerLevel), GetAddress (station));
+              extension->m_powerLevel = powerLevel;
+            }
+        }
+      station->m_txVector = WifiTxVector (entry.m_mode, powerLevel, GetLongRetryCount (station), entry.m_preamble, entry.m_guardInterval, entry.m_nss, entry.m_nss, 0, entry.m_channelWidth, aggregation, false);
+      station->m_txVectorDataRate = entry.m_dataRate;
+      station->m_txVectorRate = rate;
+      station->m_txVectorLadder = station->m_ladder;
+      station->m_txVectorAggregation = aggregation;
+      station->m_txVectorValid = true;
+      uint64_t dataRate = station->m_ladder->m_entries[GetLadderIndex (station, GetRate (station))].m_dataRate;
+      if (dataRate != station->m_tracedDataRate)
+        {
+          if (station->m_tracedDataRate != 0)
+            {
+              m_rateChange (DataRate (station->m_tracedDataRate), DataRate (dataRate), GetAddress (station));
+            }
+          station->m_tracedDataRate = dataRate;
+        }
+    }
+  station->m_txVector.SetRetries (GetLongRetryCount (station));
+  if (m_currentRate != station->m_txVectorDataRate)
+    {
+      NS_LOG_DEBUG ("New datarate: " << station->m_txVectorDataRate);
+      m_currentRate = station->m_txVectorDataRate;
+    }
+  return station->m_txVector;
+}
+
+/*This function returns Wifi Rts transmission vector. Wifi Rts transmission vector
+contains Wifi mode, default transmission power level, Retry count, Preamble 
+for sending station, 800, 1, 1, 0, physical channel width, GetAggregation (station), false).
+With RTS rate adaptation, the mode is picked by a separate ARF controller within the
+BasicRateSet (restricted to non-ERP rates when non-ERP protection is in use); otherwise
+it is the lowest supported rate.
+*/
+template <class Policy>
+WifiTxVector
+ArfFamilyWifiManager<Policy>::DoGetRtsTxVector (WifiRemoteStation *st)
+{
+  NS_LOG_FUNCTION (this << st);
+  ArfFamilyWifiRemoteStation *station = (ArfFamilyWifiRemoteStation *) st;
+  uint32_t channelWidth = GetChannelWidth (station);
+  if (channelWidth > 20 && channelWidth != 22)
+    {
+      //avoid to use legacy rate adaptation algorithms for IEEE 802.11n/ac
+      channelWidth = 20;
+    }
+  WifiTxVector rtsTxVector;
+  WifiMode mode;
+  if (m_rtsRateAdaptation && CheckRtsModes ())
+    {
+      uint32_t rate = std::min<uint32_t> (GetExtension (station)->m_rtsState.GetRate (), m_rtsModes.size () - 1);
+      mode = m_rtsModes[rate];
+    }
+  else if (GetUseNonErpProtection () == false)
+    {
+      mode = GetSupported (station, 0);
+    }
+  else
+    {
+      mode = GetNonErpSupported (station, 0);
+    }
+  rtsTxVector = WifiTxVector (mode, GetDefaultTxPowerLevel (), GetLongRetryCount (station), GetPreambleForTransmission (mode, GetAddress (station)), 800, 1, 1, 0, channelWidth, GetAggregation (station), false);
+  return rtsTxVector;
+}
+
+/*CheckRtsModes keeps the list of modes the RTS rate controller walks through in
+sync with the BasicRateSet and the non-ERP protection setting, which are the same
+for every station.
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::CheckRtsModes (void)
+{
+  bool nonErpProtection = GetUseNonErpProtection ();
+  if (!m_rtsModesValid
+      || m_rtsModesNBasic != GetNBasicModes ()
+      || m_rtsModesNonErpProtection != nonErpProtection)
+    {
+      m_rtsModes.clear ();
+      for (uint32_t i = 0; i < GetNBasicModes (); i++)
+        {
+          WifiMode mode = GetBasicMode (i);
+          WifiModulationClass modulationClass = mode.GetModulationClass ();
+          bool nonErp = modulationClass == WIFI_MOD_CLASS_DSSS || modulationClass == WIFI_MOD_CLASS_HR_DSSS;
+          if (modulationClass == WIFI_MOD_CLASS_HT
+              || modulationClass == WIFI_MOD_CLASS_VHT
+              || modulationClass == WIFI_MOD_CLASS_HE
+              || (nonErpProtection && !nonErp))
+            {
+              continue;
+            }
+          m_rtsModes.push_back (mode);
+        }
+      m_rtsModesNBasic = GetNBasicModes ();
+      m_rtsModesNonErpProtection = nonErpProtection;
+      m_rtsModesValid = true;
+      NS_LOG_DEBUG ("RTS rate controller uses " << m_rtsModes.size () << " basic rates");
+    }
+  return !m_rtsModes.empty ();
+}
+
+/*GetRtsRateControl returns the ARF controller used for RTS frames, with its
+thresholds taken from the RtsSuccessThreshold and RtsTimerThreshold attributes.
+*/
+template <class Policy>
+ArfFamilyRateControl<ArfThresholdPolicy>
+ArfFamilyWifiManager<Policy>::GetRtsRateControl (void) const
+{
+  ArfFamilyRateControl<ArfThresholdPolicy> rtsRateControl;
+  rtsRateControl.m_successThreshold = m_rtsSuccessThreshold;
+  rtsRateControl.m_timerThreshold = m_rtsTimerThreshold;
+  return rtsRateControl;
+}
+
+/*IsLowLatency function returns whether this manager is a manager 
+designed to work in low-latency environments. It always is, staged fallback mode
+included: the stage of each attempt is picked in DoGetDataTxVector, which must be called before every attempt,
+while a high-latency manager only gets one call when the packet is queued.
+*/
+template <class Policy>
+bool
+ArfFamilyWifiManager<Policy>::IsLowLatency (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+template class ArfFamilyWifiManager<ArfThresholdPolicy>;
+template class ArfFamilyWifiManager<AarfThresholdPolicy>;
+
+} //namespace ns3
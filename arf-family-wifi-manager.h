@@ -0,0 +1,1513 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+
+#ifndef ARF_FAMILY_WIFI_MANAGER_H
+#define ARF_FAMILY_WIFI_MANAGER_H
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/unused.h"
+#include "wifi-remote-station-manager.h"
+
+namespace ns3 {
+
+struct ArfFamilyWifiRemoteStation;
+struct ArfFamilyStationExtension;
+struct ArfFamilyStatsRecord;
+class ArfFamilyStationPool;
+
+/**
+ * \brief one step of the ARF-family rate ladder
+ */
+struct ArfRateLadderEntry
+{
+  WifiMode m_mode; ///< mode used at this step
+  uint8_t m_nss; ///< number of spatial streams
+  uint16_t m_guardInterval; ///< guard interval (ns)
+  uint16_t m_channelWidth; ///< channel width (MHz)
+  uint64_t m_dataRate; ///< data rate (b/s) of the mode with this width, guard interval and nss
+  WifiPreamble m_preamble; ///< preamble used with the mode
+  double m_snrThreshold; ///< minimum SNR (linear) for the target BER, only computed in SNR-aided mode
+};
+
+/**
+ * \brief rate ladder shared by all the stations with the same supported set
+ *
+ * The ladder holds everything the ARF-family hot path needs for each rate
+ * index so that stepping up or down is plain array indexing.
+ */
+struct ArfRateLadder
+{
+  std::vector<ArfRateLadderEntry> m_entries; ///< one entry per usable rate, lowest first
+  uint32_t m_nSupported; ///< size of the station supported set the ladder was built from
+  uint32_t m_nMcsSupported; ///< size of the station MCS set the ladder was built from
+  uint32_t m_stationChannelWidth; ///< station channel width the ladder was built for
+  bool m_shortPreamble; ///< short preamble setting the preambles were computed for
+  bool m_greenfieldProtection; ///< greenfield protection setting the preambles were computed for
+
+  /**
+   * Order the entries of an MCS ladder holding several channel widths.
+   * Each width only keeps its entries faster than every entry of the
+   * narrower widths, so that the ladder is still sorted by data rate but
+   * its narrow widths all sit below its wide ones: falling back from the
+   * top narrows the channel from e.g. 80 to 40 to 20 MHz instead of
+   * switching width at every step.
+   */
+  void OrderByWidth (void)
+  {
+    std::stable_sort (m_entries.begin (), m_entries.end (), IsNarrowerOrSlower);
+    std::vector<ArfRateLadderEntry> entries;
+    for (std::vector<ArfRateLadderEntry>::const_iterator i = m_entries.begin (); i != m_entries.end (); i++)
+      {
+        //entries of the same width never displace each other
+        if (entries.empty ()
+            || i->m_channelWidth == entries.back ().m_channelWidth
+            || i->m_dataRate > entries.back ().m_dataRate)
+          {
+            entries.push_back (*i);
+          }
+      }
+    m_entries.swap (entries);
+  }
+  /**
+   * \param a the first entry
+   * \param b the second entry
+   * \return true if a is on a narrower channel than b, or on the same
+   *         channel width and slower
+   */
+  static bool IsNarrowerOrSlower (const ArfRateLadderEntry &a, const ArfRateLadderEntry &b)
+  {
+    if (a.m_channelWidth != b.m_channelWidth)
+      {
+        return a.m_channelWidth < b.m_channelWidth;
+      }
+    return a.m_dataRate < b.m_dataRate;
+  }
+};
+
+/**
+ * \brief window of the last transmission outcomes of a station
+ *
+ * The outcomes are kept as a bitmask, one bit per outcome with losses set,
+ * so that adding outcomes and counting the losses of the window are O(1).
+ */
+struct ArfLossWindow
+{
+  uint32_t m_losses; ///< outcomes of the window, most recent in the lowest bit, 1 for a loss
+  uint32_t m_count; ///< number of outcomes in the window
+  uint32_t m_rate; ///< rate index the outcomes were observed at
+
+  /**
+   * Empty the window.
+   *
+   * \param rate the rate index the next outcomes are observed at
+   */
+  void Reset (uint32_t rate)
+  {
+    m_losses = 0;
+    m_count = 0;
+    m_rate = rate;
+  }
+  /**
+   * Add outcomes to the window, dropping the oldest ones beyond its size.
+   *
+   * \param nSuccess the number of successful transmissions
+   * \param nFailed the number of failed transmissions
+   * \param size the size of the window, at most 32
+   */
+  void Add (uint32_t nSuccess, uint32_t nFailed, uint32_t size)
+  {
+    uint32_t n = std::min (nSuccess + nFailed, size);
+    uint32_t failed = std::min (nFailed, n);
+    uint64_t losses = (static_cast<uint64_t> (m_losses) << n) | ((static_cast<uint64_t> (1) << failed) - 1);
+    m_losses = static_cast<uint32_t> (losses & ((static_cast<uint64_t> (1) << size) - 1));
+    m_count = std::min (m_count + n, size);
+  }
+  /**
+   * \return the number of losses in the window
+   */
+  uint32_t GetNLosses (void) const
+  {
+    uint32_t v = m_losses - ((m_losses >> 1) & 0x55555555);
+    v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+    return (((v + (v >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+  }
+};
+
+/**
+ * \brief operating point of a peer kept across reassociations
+ */
+struct ArfRateMemoryEntry
+{
+  Mac48Address m_address; ///< address of the peer
+  const ArfRateLadder *m_ladder; ///< ladder m_rate is an index of
+  uint32_t m_rate; ///< last rate index the peer succeeded at
+  uint32_t m_successThreshold; ///< success threshold of the peer
+  uint32_t m_timerTimeout; ///< timer timeout of the peer
+  Time m_lastUpdate; ///< last time the entry was updated
+};
+
+/**
+ * \brief rate control statistics of a station
+ *
+ * The counters live in fixed-size arrays so that keeping them up to date
+ * never allocates. Every rate index of a ladder the compact state can
+ * index has its own counters. Only ladders of the full state can be
+ * longer, e.g. HE with many streams or power control: their indices from
+ * MAX_RATES up share the overflow bucket, entry MAX_RATES of the arrays
+ * (see GetRateBucket). Retry counts beyond the array are counted in its
+ * last entry.
+ */
+struct ArfFamilyStationStats
+{
+  static const uint32_t MAX_RATES = 128; ///< number of rate indices with their own counters
+  static const uint32_t MAX_RETRIES = 8; ///< number of retry counts with their own counters
+
+  Time m_timeAtRate[MAX_RATES + 1]; ///< time spent at each rate index, then in the overflow bucket
+  uint64_t m_framesAtRate[MAX_RATES + 1]; ///< frames sent at each rate index, then in the overflow bucket
+  uint64_t m_retries[MAX_RETRIES]; ///< packets delivered after each number of retries
+  uint64_t m_nDropped; ///< packets dropped after their last retry
+  uint64_t m_nIncreases; ///< rate increases
+  uint64_t m_nDecreases; ///< rate decreases
+  uint64_t m_nRecoveries; ///< entries in recovery mode
+  uint64_t m_nFailedProbes; ///< rate decreases while in recovery mode
+  uint32_t m_rate; ///< current rate index
+  bool m_recovery; ///< whether the peer is in recovery mode
+  uint32_t m_successThreshold; ///< current success threshold
+  uint32_t m_timerTimeout; ///< current timer timeout
+  uint32_t m_attempts; ///< failed attempts of the current packet
+  Time m_rateStart; ///< time m_rate was entered, or its time last accounted
+
+  /**
+   * Clear the counters.
+   *
+   * \param rate the current rate index
+   * \param now the current time
+   */
+  void Reset (uint32_t rate, Time now)
+  {
+    for (uint32_t i = 0; i <= MAX_RATES; i++)
+      {
+        m_timeAtRate[i] = Time ();
+        m_framesAtRate[i] = 0;
+      }
+    for (uint32_t i = 0; i < MAX_RETRIES; i++)
+      {
+        m_retries[i] = 0;
+      }
+    m_nDropped = 0;
+    m_nIncreases = 0;
+    m_nDecreases = 0;
+    m_nRecoveries = 0;
+    m_nFailedProbes = 0;
+    m_rate = rate;
+    m_recovery = false;
+    m_successThreshold = 0;
+    m_timerTimeout = 0;
+    m_attempts = 0;
+    m_rateStart = now;
+  }
+  /**
+   * Add the time spent at the current rate index since it was last
+   * accounted.
+   *
+   * \param now the current time
+   */
+  void AccountTime (Time now)
+  {
+    m_timeAtRate[GetRateBucket (m_rate)] += now - m_rateStart;
+    m_rateStart = now;
+  }
+  /**
+   * \param rate a rate index
+   * \return the entry of the arrays counting the rate index: the index
+   *         itself, or MAX_RATES, the overflow bucket, for the indices
+   *         from MAX_RATES up
+   */
+  static uint32_t GetRateBucket (uint32_t rate)
+  {
+    return std::min (rate, MAX_RATES);
+  }
+};
+
+/**
+ * \brief threshold policy of the original ARF algorithm
+ *
+ * The success and timer thresholds are fixed: fallbacks leave them untouched
+ * and stations are compared against the thresholds of the policy itself,
+ * so that changing the attributes during a run applies to every station.
+ */
+struct ArfThresholdPolicy
+{
+  uint32_t m_timerThreshold; ///< timer threshold
+  uint32_t m_successThreshold; ///< success threshold
+
+  /**
+   * \return the name of the policy, used to name the engine TypeId
+   */
+  static std::string GetName (void)
+  {
+    return "Arf";
+  }
+  /**
+   * \return the success threshold of a new station
+   */
+  uint32_t GetInitialSuccessThreshold (void) const
+  {
+    return m_successThreshold;
+  }
+  /**
+   * \return the timer timeout of a new station
+   */
+  uint32_t GetInitialTimerTimeout (void) const
+  {
+    return m_timerThreshold;
+  }
+  /**
+   * \param successThreshold the success threshold of the station
+   * \return the success threshold the station is compared against: the
+   *         attribute, so that changing it applies to existing stations
+   */
+  uint32_t GetSuccessThreshold (uint32_t successThreshold) const
+  {
+    NS_UNUSED (successThreshold);
+    return m_successThreshold;
+  }
+  /**
+   * \param timerTimeout the timer timeout of the station
+   * \return the timer timeout the station is compared against: the
+   *         attribute, so that changing it applies to existing stations
+   */
+  uint32_t GetTimerTimeout (uint32_t timerTimeout) const
+  {
+    NS_UNUSED (timerTimeout);
+    return m_timerThreshold;
+  }
+  /**
+   * \return the largest success threshold set by the attributes
+   */
+  uint32_t GetLargestSuccessThreshold (void) const
+  {
+    return m_successThreshold;
+  }
+  /**
+   * \return the largest timer threshold set by the attributes
+   */
+  uint32_t GetLargestTimerThreshold (void) const
+  {
+    return m_timerThreshold;
+  }
+  /**
+   * Update the station thresholds when the first transmission after a
+   * rate increase failed.
+   *
+   * \param successThreshold the station success threshold
+   * \param timerTimeout the station timer timeout
+   */
+  void RecoveryFallback (uint32_t &successThreshold, uint32_t &timerTimeout) const
+  {
+    NS_UNUSED (successThreshold);
+    NS_UNUSED (timerTimeout);
+  }
+  /**
+   * Update the station thresholds after two consecutive failures.
+   *
+   * \param successThreshold the station success threshold
+   * \param timerTimeout the station timer timeout
+   */
+  void NormalFallback (uint32_t &successThreshold, uint32_t &timerTimeout) const
+  {
+    NS_UNUSED (successThreshold);
+    NS_UNUSED (timerTimeout);
+  }
+};
+
+/**
+ * \brief threshold policy of the AARF algorithm
+ *
+ * A failed probe multiplies the success threshold and the timer timeout,
+ * a normal fallback resets them to their minimum.
+ */
+struct AarfThresholdPolicy
+{
+  uint32_t m_minTimerThreshold; ///< minimum timer threshold
+  uint32_t m_minSuccessThreshold; ///< minimum success threshold
+  double m_successK; ///< Multiplication factor for the success threshold
+  uint32_t m_maxSuccessThreshold; ///< maximum success threshold
+  double m_timerK; ///< Multiplication factor for the timer threshold
+
+  /**
+   * \return the name of the policy, used to name the engine TypeId
+   */
+  static std::string GetName (void)
+  {
+    return "Aarf";
+  }
+  /**
+   * \return the success threshold of a new station
+   */
+  uint32_t GetInitialSuccessThreshold (void) const
+  {
+    return m_minSuccessThreshold;
+  }
+  /**
+   * \return the timer timeout of a new station
+   */
+  uint32_t GetInitialTimerTimeout (void) const
+  {
+    return m_minTimerThreshold;
+  }
+  /**
+   * \param successThreshold the success threshold of the station
+   * \return the success threshold the station is compared against
+   */
+  uint32_t GetSuccessThreshold (uint32_t successThreshold) const
+  {
+    return successThreshold;
+  }
+  /**
+   * \param timerTimeout the timer timeout of the station
+   * \return the timer timeout the station is compared against
+   */
+  uint32_t GetTimerTimeout (uint32_t timerTimeout) const
+  {
+    return timerTimeout;
+  }
+  /**
+   * \return the largest success threshold set by the attributes
+   */
+  uint32_t GetLargestSuccessThreshold (void) const
+  {
+    return std::max (m_minSuccessThreshold, m_maxSuccessThreshold);
+  }
+  /**
+   * \return the largest timer threshold set by the attributes; failed
+   *         probes multiply it further, without bound
+   */
+  uint32_t GetLargestTimerThreshold (void) const
+  {
+    return m_minTimerThreshold;
+  }
+  /**
+   * Update the station thresholds when the first transmission after a
+   * rate increase failed.
+   *
+   * \param successThreshold the station success threshold
+   * \param timerTimeout the station timer timeout
+   */
+  void RecoveryFallback (uint32_t &successThreshold, uint32_t &timerTimeout) const
+  {
+    successThreshold = (int)(std::min (successThreshold * m_successK, (double) m_maxSuccessThreshold));
+    timerTimeout = (int)(std::max (timerTimeout * m_timerK, (double) m_minSuccessThreshold));
+  }
+  /**
+   * Update the station thresholds after two consecutive failures.
+   *
+   * \param successThreshold the station success threshold
+   * \param timerTimeout the station timer timeout
+   */
+  void NormalFallback (uint32_t &successThreshold, uint32_t &timerTimeout) const
+  {
+    timerTimeout = m_minTimerThreshold;
+    successThreshold = m_minSuccessThreshold;
+  }
+};
+
+/**
+ * \brief per-station state of the ARF family state machine
+ */
+struct ArfFamilyState
+{
+  static const uint32_t MAX_RATES = 0xffffffff; ///< largest ladder the state can index
+
+  uint32_t m_timer; ///< timer value
+  uint32_t m_success; ///< success count
+  uint32_t m_failed; ///< failed count
+  bool m_recovery; ///< recovery
+  uint32_t m_retry; ///< retry count
+  uint32_t m_timerTimeout; ///< timer timeout
+  uint32_t m_successThreshold; ///< success threshold
+  uint32_t m_rate; ///< rate
+
+  /// \return the rate index
+  uint32_t GetRate (void) const
+  {
+    return m_rate;
+  }
+  /// \param rate the rate index
+  void SetRate (uint32_t rate)
+  {
+    m_rate = rate;
+  }
+  /// \return whether the station is in recovery mode
+  bool GetRecovery (void) const
+  {
+    return m_recovery;
+  }
+  /// \param recovery whether the station is in recovery mode
+  void SetRecovery (bool recovery)
+  {
+    m_recovery = recovery;
+  }
+  /// \return the retry count
+  uint32_t GetRetry (void) const
+  {
+    return m_retry;
+  }
+  /// Increment the retry count
+  void IncrementRetry (void)
+  {
+    m_retry++;
+  }
+  /// Reset the retry count
+  void ResetRetry (void)
+  {
+    m_retry = 0;
+  }
+  /// \return the success count
+  uint32_t GetSuccess (void) const
+  {
+    return m_success;
+  }
+  /// Increment the success count
+  void IncrementSuccess (void)
+  {
+    m_success++;
+  }
+  /// \param n the number of successes to add to the success count
+  void AddSuccess (uint32_t n)
+  {
+    m_success += n;
+  }
+  /// Reset the success count
+  void ResetSuccess (void)
+  {
+    m_success = 0;
+  }
+  /// \return the timer value
+  uint32_t GetTimer (void) const
+  {
+    return m_timer;
+  }
+  /// Increment the timer
+  void IncrementTimer (void)
+  {
+    m_timer++;
+  }
+  /// \param n the number of transmissions to add to the timer
+  void AddTimer (uint32_t n)
+  {
+    m_timer += n;
+  }
+  /// Reset the timer
+  void ResetTimer (void)
+  {
+    m_timer = 0;
+  }
+  /// Increment the failed count
+  void IncrementFailed (void)
+  {
+    m_failed++;
+  }
+  /// Reset the failed count
+  void ResetFailed (void)
+  {
+    m_failed = 0;
+  }
+  /// \return the success threshold
+  uint32_t GetSuccessThreshold (void) const
+  {
+    return m_successThreshold;
+  }
+  /// \param threshold the success threshold
+  void SetSuccessThreshold (uint32_t threshold)
+  {
+    m_successThreshold = threshold;
+  }
+  /// \return the timer timeout
+  uint32_t GetTimerTimeout (void) const
+  {
+    return m_timerTimeout;
+  }
+  /// \param timeout the timer timeout
+  void SetTimerTimeout (uint32_t timeout)
+  {
+    m_timerTimeout = timeout;
+  }
+};
+
+/**
+ * \brief bit-packed per-station state of the ARF family state machine
+ *
+ * Holds the same state as ArfFamilyState in 8 bytes: the rate index and
+ * the recovery flag share a byte, the retry count, success count and
+ * success threshold take a byte each and the timer and timer timeout 16
+ * bits each. Counters and thresholds saturate instead of wrapping; the
+ * retry count saturates while keeping its parity, which is what the
+ * fallback logic looks at. The failed count is not kept since no ARF
+ * variant reads it, and ladders are limited to MAX_RATES rates.
+ *
+ * The masks and saturating updates make each transition about 1.1 times
+ * slower than with ArfFamilyState when the state is in the caches, so the
+ * compact form only pays off when the number of stations makes the full
+ * state no longer fit in them.
+ */
+class ArfFamilyCompactState
+{
+public:
+  static const uint32_t MAX_RATES = 0x7f + 1; ///< largest ladder the state can index
+
+  /// \return the rate index
+  uint32_t GetRate (void) const
+  {
+    return m_rateRecovery & 0x7f;
+  }
+  /// \param rate the rate index, below MAX_RATES
+  void SetRate (uint32_t rate)
+  {
+    m_rateRecovery = (m_rateRecovery & 0x80) | rate;
+  }
+  /// \return whether the station is in recovery mode
+  bool GetRecovery (void) const
+  {
+    return (m_rateRecovery & 0x80) != 0;
+  }
+  /// \param recovery whether the station is in recovery mode
+  void SetRecovery (bool recovery)
+  {
+    m_rateRecovery = (m_rateRecovery & 0x7f) | (recovery ? 0x80 : 0);
+  }
+  /// \return the retry count
+  uint32_t GetRetry (void) const
+  {
+    return m_retry;
+  }
+  /// Increment the retry count
+  void IncrementRetry (void)
+  {
+    m_retry = (m_retry == 0xff) ? 0xfe : m_retry + 1;
+  }
+  /// Reset the retry count
+  void ResetRetry (void)
+  {
+    m_retry = 0;
+  }
+  /// \return the success count
+  uint32_t GetSuccess (void) const
+  {
+    return m_success;
+  }
+  /// Increment the success count
+  void IncrementSuccess (void)
+  {
+    m_success += (m_success != 0xff);
+  }
+  /// \param n the number of successes to add to the success count
+  void AddSuccess (uint32_t n)
+  {
+    m_success = std::min<uint32_t> (m_success + n, 0xff);
+  }
+  /// Reset the success count
+  void ResetSuccess (void)
+  {
+    m_success = 0;
+  }
+  /// \return the timer value
+  uint32_t GetTimer (void) const
+  {
+    return m_timer;
+  }
+  /// Increment the timer
+  void IncrementTimer (void)
+  {
+    m_timer += (m_timer != 0xffff);
+  }
+  /// \param n the number of transmissions to add to the timer
+  void AddTimer (uint32_t n)
+  {
+    m_timer = std::min<uint32_t> (m_timer + n, 0xffff);
+  }
+  /// Reset the timer
+  void ResetTimer (void)
+  {
+    m_timer = 0;
+  }
+  /// The failed count is not kept
+  void IncrementFailed (void)
+  {
+  }
+  /// The failed count is not kept
+  void ResetFailed (void)
+  {
+  }
+  /// \return the success threshold
+  uint32_t GetSuccessThreshold (void) const
+  {
+    return m_successThreshold;
+  }
+  /// \param threshold the success threshold
+  void SetSuccessThreshold (uint32_t threshold)
+  {
+    m_successThreshold = std::min<uint32_t> (threshold, 0xff);
+  }
+  /// \return the timer timeout
+  uint32_t GetTimerTimeout (void) const
+  {
+    return m_timerTimeout;
+  }
+  /// \param timeout the timer timeout
+  void SetTimerTimeout (uint32_t timeout)
+  {
+    m_timerTimeout = std::min<uint32_t> (timeout, 0xffff);
+  }
+
+private:
+  uint8_t m_rateRecovery; ///< recovery flag (bit 7) and rate index (bits 0-6)
+  uint8_t m_retry; ///< retry count
+  uint8_t m_success; ///< success count
+  uint8_t m_successThreshold; ///< success threshold
+  uint16_t m_timer; ///< timer value
+  uint16_t m_timerTimeout; ///< timer timeout
+};
+
+/**
+ * \brief the ARF family state machine
+ *
+ * Implements the success/failure transitions shared by all the ARF
+ * variants on any of the per-station state representations
+ * (ArfFamilyState, ArfFamilyCompactState). The threshold updates are
+ * delegated to the Policy. The engine does not depend on the rest of the
+ * simulator and can be driven directly.
+ *
+ * The per-outcome transitions are defined inline: the compiler only
+ * folds template members defined outside the class into their callers
+ * when they are small, and the out-of-line calls made the engine about
+ * 1.3 times slower per transition than the code it replaced.
+ */
+template <class Policy>
+class ArfFamilyRateControl : public Policy
+{
+public:
+  /**
+   * Initialize the state of a new station.
+   *
+   * \param state the station state
+   */
+  template <class State>
+  void InitState (State &state) const;
+  /**
+   * Update the state after a successful data transmission.
+   *
+   * \param state the station state
+   * \param nRates the number of rates in the station ladder
+   * \return true if the rate was increased
+   */
+  template <class State>
+  bool UpdateOnDataOk (State &state, uint32_t nRates) const;
+  /**
+   * Update the state after a successful data transmission, with a timer
+   * kept by the caller (e.g. in simulation time) instead of the packet
+   * count of the state. The packet count still restarts from zero whenever
+   * the timer is reset, which lets the caller restart its own timer.
+   *
+   * \param state the station state
+   * \param nRates the number of rates in the station ladder
+   * \param timerExpired whether the timer of the caller has expired
+   * \return true if the rate was increased
+   */
+  template <class State>
+  bool UpdateOnDataOk (State &state, uint32_t nRates, bool timerExpired) const;
+  /**
+   * Update the state after a failed data transmission.
+   *
+   * \param state the station state
+   * \return true if the rate was decreased
+   */
+  template <class State>
+  bool UpdateOnDataFailed (State &state) const;
+  /**
+   * Update the state after the transmission of an aggregate.
+   *
+   * The aggregate counts as a single transmission. If it failed (see
+   * IsAggregateFailed), it is handled as one failed data transmission.
+   * Otherwise the Block Ack ends any recovery or retry sequence and the
+   * timer grows by the number of MPDUs. The success count grows by the
+   * number of acknowledged MPDUs if none failed, and restarts from zero
+   * otherwise. The rate is increased when the success count or the timer
+   * reaches its threshold, since they can step over it.
+   *
+   * \param state the station state
+   * \param nSuccess the number of acknowledged MPDUs
+   * \param nFailed the number of MPDUs that were not acknowledged
+   * \param nRates the number of rates in the station ladder
+   * \return true if the rate was changed
+   */
+  template <class State>
+  bool UpdateOnAggregate (State &state, uint32_t nSuccess, uint32_t nFailed, uint32_t nRates) const;
+  /**
+   * Update the state after the transmission of an aggregate, with a timer
+   * kept by the caller instead of the packet count of the state.
+   *
+   * \param state the station state
+   * \param nSuccess the number of acknowledged MPDUs
+   * \param nFailed the number of MPDUs that were not acknowledged
+   * \param nRates the number of rates in the station ladder
+   * \param timerExpired whether the timer of the caller has expired
+   * \return true if the rate was changed
+   */
+  template <class State>
+  bool UpdateOnAggregate (State &state, uint32_t nSuccess, uint32_t nFailed, uint32_t nRates,
+                          bool timerExpired) const;
+  /**
+   * An aggregate fails when less than half of its MPDUs are acknowledged.
+   * Counting any acknowledged MPDU as a success would let a station that
+   * loses most of each aggregate climb on the timer and never fall back.
+   *
+   * \param nSuccess the number of acknowledged MPDUs
+   * \param nFailed the number of MPDUs that were not acknowledged
+   * \return true if the aggregate counts as a failed transmission
+   */
+  static bool IsAggregateFailed (uint32_t nSuccess, uint32_t nFailed)
+  {
+    return nSuccess == 0 || nFailed > nSuccess;
+  }
+  /**
+   * Move directly to another rate, e.g. when the SNR supports a jump of
+   * several steps. The counters restart at the new rate and a jump up is
+   * handled as a probe: the station is in recovery until the next success.
+   *
+   * \param state the station state
+   * \param rate the new rate index
+   * \return true if the rate was changed
+   */
+  template <class State>
+  bool JumpToRate (State &state, uint32_t rate) const;
+  /**
+   * Fall back to a lower rate at once, e.g. after a packet was dropped,
+   * updating the thresholds as after a normal fallback.
+   *
+   * \param state the station state
+   * \param rate the new rate index, lower than the current one
+   * \return true if the rate was changed
+   */
+  template <class State>
+  bool FallBackTo (State &state, uint32_t rate) const;
+
+private:
+  /**
+   * Count a success and increase the rate if the success count reached
+   * its threshold or the timer expired.
+   *
+   * \param state the station state
+   * \param nSuccess the number of successes to count, 0 to restart the count
+   * \param timerExpired whether the timer expired
+   * \param nRates the number of rates in the station ladder
+   * \return true if the rate was increased
+   */
+  template <class State>
+  bool UpdateOnSuccess (State &state, uint32_t nSuccess, bool timerExpired, uint32_t nRates) const;
+};
+
+/**
+ * \ingroup wifi
+ * \brief common engine of the ARF family of rate control algorithms
+ *
+ * ARF and its variants share the same per-station state machine and only
+ * differ in how the success and timer thresholds evolve on fallbacks. That
+ * part is a compile-time policy: the policy hooks are plain inline member
+ * functions of the Policy class, so the hot path has no virtual dispatch
+ * beyond the WifiRemoteStationManager callbacks themselves. The tunables
+ * of the policy are inherited so that the concrete managers can expose
+ * them as attributes.
+ *
+ * Stations keep the state machine in an ArfFamilyState, or in an
+ * ArfFamilyCompactState when the CompactStationState attribute is set,
+ * which is meant for scenarios with a very large number of stations.
+ *
+ * A new variant only needs a policy class providing
+ * GetInitialSuccessThreshold, GetInitialTimerTimeout, RecoveryFallback and
+ * NormalFallback, and an explicit instantiation in
+ * arf-family-wifi-manager.cc.
+ *
+ * For legacy stations the ladder is the supported rate set. For HT, VHT
+ * and HE stations it is made of the MCSs of the best modulation class
+ * both ends support, for every usable number of spatial streams, at the
+ * widest common channel width and shortest common guard interval,
+ * ordered by data rate. With the ChannelWidthAdaptation attribute, the
+ * ladder also holds the narrower channel widths, so that the channel
+ * width is adapted as a second dimension of the ladder. With the
+ * GoodputLadder attribute, legacy ladders are ordered by the goodput of a
+ * GoodputFrameSize frame instead of the supported set order, and rates
+ * that a faster rate needing no more SNR dominates are left out, which
+ * matters for mixed DSSS/ERP-OFDM rate sets.
+ *
+ * By default the timer counts transmissions. With the TimeBasedTimer
+ * attribute it expires after ProbeInterval of simulation time instead, as
+ * in the original ARF design, scaled by the ratio of the current timer
+ * threshold of the station to its initial value so that AARF still
+ * stretches it. The timer is checked on each transmission outcome against
+ * the time of its last reset: no event is scheduled per station.
+ *
+ * With the StagedFallback attribute each packet is retried in fixed
+ * stages: the rate of the state machine at its first attempt, the next
+ * lower rate and the lowest rate, each tried StagedFallbackCurrentTries,
+ * StagedFallbackLowerTries and StagedFallbackLowestTries times. Only the
+ * outcomes of the first stage drive the state machine. This is not a
+ * multi-rate retry chain: the WifiTxVector of this version cannot carry
+ * one, so nothing is handed to the MAC, the manager stays low latency and
+ * the tx vector asked for before every attempt picks the stage from the
+ * attempts already made. The count lives in the station, and the base
+ * class keeps one station per (address, TID), so each TID follows the
+ * stages of its own current packet.
+ *
+ * With the PowerControl attribute the manager also adapts the transmit
+ * power, as in PARF (on top of ARF) and APARF (on top of AARF): the ladder
+ * is extended above its fastest rate with one position per lower power
+ * level. A success streak at the fastest rate lowers the power one level
+ * and failures at a reduced power raise it before the rate is lowered,
+ * with the same success, timer and recovery rules as rate changes. Power
+ * changes are reported by the PowerChange trace source.
+ *
+ * With a non-zero RateMemorySize, the last rate a peer succeeded at and
+ * its thresholds are kept in a least recently used cache keyed by the
+ * peer address, so that a peer which reassociates within
+ * RateMemoryLifetime resumes from there instead of from the lowest rate.
+ *
+ * With the LossWindow attribute, the success and failure counts are
+ * replaced by a window of the last LossWindowSize outcomes of the
+ * station, as in RRAA: the rate goes up when the loss ratio of a full
+ * window is at most LossWindowRaiseThreshold and down as soon as the
+ * losses of the window reach LossWindowLowerThreshold, which is less
+ * sensitive to random losses than consecutive counts.
+ *
+ * When a packet is dropped after its last retry, FinalFailureSteps and
+ * FinalFailureFloor make the station fall back several rates at once, or
+ * straight to a safe rate, with the thresholds reset as after a normal
+ * fallback. The rate is then not increased for FinalFailureHoldOff
+ * successful transmissions.
+ *
+ * With the Statistics attribute, the manager keeps rate control counters
+ * per station (ArfFamilyStationStats), which GetStationStats returns and
+ * EnableStationStatsDump prints periodically, without NS_LOG. They are
+ * allocated from a pool of the manager along with the station extension
+ * and cover the life of the station: the base class keeps one station per
+ * (address, TID) and deletes them all on Reset.
+ *
+ * The RateChange trace source fires when the data rate of a station
+ * changes, with the old and new rates and the address of the peer. The
+ * Rate trace source of the derived managers follows whichever station
+ * transmits, so it fires at every frame with several peers at different
+ * rates, and is deprecated.
+ */
+template <class Policy>
+class ArfFamilyWifiManager : public WifiRemoteStationManager,
+                             public ArfFamilyRateControl<Policy>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  ArfFamilyWifiManager ();
+  virtual ~ArfFamilyWifiManager ();
+
+  // Inherited from WifiRemoteStationManager
+  void SetupPhy (const Ptr<WifiPhy> phy);
+
+  /**
+   * Get the rate control statistics of the station of a peer. Requires the
+   * Statistics attribute.
+   *
+   * \param address the address of the peer
+   * \param tid the TID of the station, 0 for non-QoS traffic
+   * \param stats the statistics, with the time at the current rate up to now
+   * \return true if the manager has statistics for the station
+   */
+  bool GetStationStats (Mac48Address address, uint8_t tid, ArfFamilyStationStats &stats) const;
+  /**
+   * Print the rate control statistics of all the stations, one line per
+   * station.
+   *
+   * \param os the stream to print to
+   */
+  void PrintStationStats (std::ostream &os) const;
+  /**
+   * Print the rate control statistics of all the stations every interval,
+   * starting one interval from now. Requires the Statistics attribute.
+   *
+   * \param stream the stream to print to
+   * \param interval the interval between two dumps
+   */
+  void EnableStationStatsDump (Ptr<OutputStreamWrapper> stream, Time interval);
+
+protected:
+  TracedValue<uint64_t> m_currentRate; //!< Trace rate changes, of whichever station transmits
+
+
+private:
+  //overriden from base class
+  WifiRemoteStation * DoCreateStation (void) const;
+  void DoReportRxOk (WifiRemoteStation *station,
+                     double rxSnr, WifiMode txMode);
+  void DoReportRtsFailed (WifiRemoteStation *station);
+  void DoReportDataFailed (WifiRemoteStation *station);
+  void DoReportRtsOk (WifiRemoteStation *station,
+                      double ctsSnr, WifiMode ctsMode, double rtsSnr);
+  void DoReportDataOk (WifiRemoteStation *station,
+                       double ackSnr, WifiMode ackMode, double dataSnr);
+  void DoReportAmpduTxStatus (WifiRemoteStation *station,
+                              uint8_t nSuccessfulMpdus, uint8_t nFailedMpdus,
+                              double rxSnr, double dataSnr);
+  bool DoNeedRts (WifiRemoteStation *station,
+                  Ptr<const Packet> packet, bool normally);
+  bool DoNeedDataRetransmission (WifiRemoteStation *station,
+                                 Ptr<const Packet> packet, bool normally);
+  void DoReportFinalRtsFailed (WifiRemoteStation *station);
+  void DoReportFinalDataFailed (WifiRemoteStation *station);
+  WifiTxVector DoGetDataTxVector (WifiRemoteStation *station);
+  WifiTxVector DoGetRtsTxVector (WifiRemoteStation *station);
+  bool IsLowLatency (void) const;
+  void DoDispose (void);
+
+  /**
+   * Make sure the station refers to a rate ladder matching its current
+   * supported set, channel width and preamble setting, building or
+   * reusing one if needed.
+   *
+   * \param station the station to check
+   */
+  void CheckLadder (ArfFamilyWifiRemoteStation *station);
+  /**
+   * Fill the entries of a rate ladder for a station.
+   *
+   * \param station the station
+   * \param ladder the ladder to fill
+   */
+  void BuildLadder (const ArfFamilyWifiRemoteStation *station, ArfRateLadder &ladder);
+  /**
+   * Stop the simulation if the compact station state cannot hold the
+   * thresholds of the attributes.
+   */
+  void CheckCompactThresholds (void) const;
+  /**
+   * Order the entries of a ladder by expected goodput and remove the
+   * entries that another entry dominates: as fast or faster, with a lower
+   * or equal SNR threshold. The SNR thresholds must have been computed.
+   *
+   * \param ladder the ladder to sort and prune
+   */
+  void SortLadderByGoodput (ArfRateLadder &ladder) const;
+  /**
+   * Call a functor on the state of the ARF state machine of a station, in
+   * whichever representation the stations of the manager hold it. Every
+   * access to the state goes through here, so that an operation cannot
+   * handle only one of the two representations.
+   *
+   * \param station the station
+   * \param f a functor with a Result type and a call operator templated on
+   *        the state, called with an ArfFamilyState or an ArfFamilyCompactState
+   * \return the result of the functor
+   */
+  template <class Functor>
+  typename Functor::Result ApplyToState (const ArfFamilyWifiRemoteStation *station, const Functor &f) const;
+  /**
+   * \param station the station
+   * \return the rate index of the station
+   */
+  uint32_t GetRate (const ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * \param station the station
+   * \param rate the new rate index of the station
+   */
+  void SetRate (ArfFamilyWifiRemoteStation *station, uint32_t rate) const;
+  /**
+   * \param station the station
+   * \return the number of ladder positions the station state can use: the
+   *         ladder rates, plus one per reduced power level with power control
+   */
+  uint32_t GetNRates (const ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * \param station the station
+   * \param rate a ladder position of the station
+   * \return the index of the ladder entry used at this position
+   */
+  uint32_t GetLadderIndex (const ArfFamilyWifiRemoteStation *station, uint32_t rate) const;
+  /**
+   * \param station the station
+   * \param rate a ladder position of the station
+   * \return the transmit power level used at this position
+   */
+  uint8_t GetPowerLevel (const ArfFamilyWifiRemoteStation *station, uint32_t rate) const;
+  /**
+   * Rebuild the modes used by the RTS rate controller if the BasicRateSet
+   * or the non-ERP protection setting changed.
+   *
+   * \return true if there is at least one mode to use
+   */
+  bool CheckRtsModes (void);
+  /**
+   * \return the ARF controller used for RTS frames
+   */
+  ArfFamilyRateControl<ArfThresholdPolicy> GetRtsRateControl (void) const;
+  /**
+   * Check whether a failure should be handled as a possible collision by
+   * the collision-aware mode, turning RTS/CTS protection on if so.
+   *
+   * \param station the station whose transmission failed
+   * \param rtsUsed whether the failed frame was protected with RTS/CTS
+   * \return true if the failure must not reach the ARF state machine
+   */
+  bool IsPossibleCollision (ArfFamilyWifiRemoteStation *station, bool rtsUsed);
+  /**
+   * \param station the station whose data outcome is being reported
+   * \return whether a CTS was received for the data frame, which is then
+   *         forgotten
+   */
+  bool TakeRtsUsed (ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * Count a successful transmission towards turning RTS/CTS protection off.
+   *
+   * \param station the station whose transmission succeeded
+   */
+  void CountProtectedSuccess (ArfFamilyWifiRemoteStation *station);
+  /**
+   * Feed an SNR report to the SNR average of the station.
+   *
+   * \param station the station the report is about
+   * \param snr the reported SNR (linear), ignored if not positive
+   */
+  void UpdateSnr (ArfFamilyWifiRemoteStation *station, double snr) const;
+  /**
+   * In SNR-aided mode, jump several steps up or down the ladder when the
+   * SNR average of the station clearly supports another rate. Moves of a
+   * single step are left to the ARF state machine.
+   *
+   * The SNR average is only fed by successes and received frames, so it
+   * lags during a fade: after a failure, only jumps down are allowed.
+   *
+   * \param station the station to check
+   * \param success whether the last transmission succeeded
+   */
+  void CheckSnrJump (ArfFamilyWifiRemoteStation *station, bool success);
+  /**
+   * \param station the station
+   * \param snr an SNR (linear)
+   * \return the index of the fastest ladder entry whose SNR threshold, plus
+   *         the SNR margin, is below snr, or 0 if there is none
+   */
+  uint32_t GetSnrTarget (const ArfFamilyWifiRemoteStation *station, double snr) const;
+  /**
+   * \param margin the SNR margin (dB) of the SNR-aided mode
+   */
+  void SetSnrMargin (double margin);
+  /**
+   * \return the SNR margin (dB) of the SNR-aided mode
+   */
+  double GetSnrMargin (void) const;
+  /**
+   * In fast-start mode, seed the rate of a new station from the first SNR
+   * reported for it.
+   *
+   * \param station the station the report is about
+   * \param snr the reported SNR (linear), ignored if not positive
+   */
+  void CheckFastStart (ArfFamilyWifiRemoteStation *station, double snr);
+  /**
+   * The base class gives a station only the default mode until the
+   * capabilities of the peer are known, which happens after the first
+   * frames with the peer have been exchanged.
+   *
+   * \param station the station, whose ladder must be built
+   * \return true if the ladder of the station was built from the default
+   *         mode only and will likely be rebuilt
+   */
+  bool IsProvisionalLadder (const ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * \param station the station
+   * \return the state of the optional modes of the station, allocated on
+   *         first use
+   */
+  ArfFamilyStationExtension * GetExtension (ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * \param station the station
+   * \return the successes left in the hold-off of the station after a
+   *         dropped packet
+   */
+  uint32_t GetHoldOff (const ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * \return true if a mode keeping state in ArfFamilyStationExtension is
+   *         enabled
+   */
+  bool HasExtensionModes (void) const;
+  /**
+   * Parse the FastStartSnrTable attribute if it changed since last time.
+   */
+  void ParseFastStartTable (void);
+  /**
+   * Record the rate and thresholds of the station in the rate memory if
+   * its rate changed since they were last recorded, or if the record is
+   * getting old.
+   *
+   * \param station the station that just succeeded a transmission
+   */
+  void CheckRateMemory (ArfFamilyWifiRemoteStation *station);
+  /**
+   * Restore the rate and thresholds of a new station from the rate memory.
+   *
+   * \param station the station whose ladder was just built
+   */
+  void RestoreRate (ArfFamilyWifiRemoteStation *station);
+  /**
+   * Add outcomes to the loss window of the station and change its rate if
+   * the loss ratio of the window crosses a threshold.
+   *
+   * \param station the station
+   * \param nSuccess the number of successful transmissions
+   * \param nFailed the number of failed transmissions
+   * \param nRates the number of ladder positions the rate can go up to
+   * \return true if the rate was changed
+   */
+  bool UpdateLossWindow (ArfFamilyWifiRemoteStation *station, uint32_t nSuccess, uint32_t nFailed, uint32_t nRates);
+  /**
+   * Count a success against the hold-off of the station.
+   *
+   * \param station the station that succeeded a transmission
+   * \return the number of ladder positions the rate can go up to: only up
+   *         to the current rate during a hold-off
+   */
+  uint32_t GetNRatesAfterSuccess (ArfFamilyWifiRemoteStation *station);
+  /**
+   * Reset the timer of a station in hold-off, so that it does not run
+   * past the timer timeout while increases are blocked.
+   *
+   * \param station the station that succeeded a transmission in hold-off
+   */
+  void StopHoldOffTimer (ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * \param station the station to check
+   * \return true if the time-based timer of the station has expired
+   */
+  bool IsTimerExpired (ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * Restart the time-based timer of the station if the state machine has
+   * just reset its timer.
+   *
+   * \param station the station to check
+   */
+  void CheckTimerReset (ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * \param station the station
+   * \return the fallback stage of the next attempt of the current
+   *         packet of the station, 3 once the stages are exhausted
+   */
+  uint32_t GetStagedFallbackStage (ArfFamilyWifiRemoteStation *station) const;
+  /**
+   * Return the rate index of the next attempt of the current packet, and
+   * fix the stages of the packet if this is its first attempt.
+   *
+   * \param station the station
+   * \return the rate index to use
+   */
+  uint32_t GetStagedFallbackRate (ArfFamilyWifiRemoteStation *station);
+  /**
+   * \param station the station
+   * \return the statistics of the station, or 0 without the Statistics
+   *         attribute
+   */
+  ArfFamilyStationStats * GetStats (ArfFamilyWifiRemoteStation *station);
+  /**
+   * Count the outcome of a transmission in the statistics of the station.
+   *
+   * \param station the station
+   * \param nSuccess the number of successful frames
+   * \param nFailed the number of failed frames
+   */
+  void RecordOutcome (ArfFamilyWifiRemoteStation *station, uint32_t nSuccess, uint32_t nFailed);
+  /**
+   * Count the rate and recovery mode transitions of the station since
+   * they were last recorded in its statistics.
+   *
+   * \param station the station
+   */
+  void RecordTransition (ArfFamilyWifiRemoteStation *station);
+  /**
+   * Print the statistics of all the peers and schedule the next dump.
+   */
+  void DumpStationStats (void);
+
+  ArfFamilyStationPool *m_compactStationPool; ///< pool of the stations using ArfFamilyCompactState
+  ArfFamilyStationPool *m_fullStationPool; ///< pool of the stations using ArfFamilyState
+  ArfFamilyStationPool *m_extensionPool; ///< pool of the ArfFamilyStationExtension of the stations
+  bool m_compactState; ///< whether stations use ArfFamilyCompactState
+  bool m_channelWidthAdaptation; ///< whether the ladder also adapts the channel width
+  bool m_rtsRateAdaptation; ///< whether RTS frames are rate controlled
+  uint32_t m_rtsTimerThreshold; ///< timer threshold of the RTS rate controller
+  uint32_t m_rtsSuccessThreshold; ///< success threshold of the RTS rate controller
+  bool m_powerControl; ///< whether the transmit power is adapted with the rate (PARF/APARF)
+  uint8_t m_maxPowerLevel; ///< highest transmit power level of the PHY
+  TracedCallback<double, double, Mac48Address> m_powerChange; ///< trace of the power changes of the stations
+  TracedCallback<DataRate, DataRate, Mac48Address> m_rateChange; ///< trace of the data rate changes of the stations
+  bool m_stagedFallback; ///< whether packets are retried in fixed fallback stages
+  uint32_t m_stagedFallbackCurrentTries; ///< tries at the current rate
+  uint32_t m_stagedFallbackLowerTries; ///< tries at the next lower rate
+  uint32_t m_stagedFallbackLowestTries; ///< tries at the lowest rate
+  bool m_timeBasedTimer; ///< whether the timer expires after m_probeInterval instead of a number of transmissions
+  Time m_probeInterval; ///< interval after which the time-based timer expires
+  bool m_goodputLadder; ///< whether legacy ladders are sorted by goodput and pruned
+  uint32_t m_goodputFrameSize; ///< frame size (bytes) the goodput of the ladder rates is computed for
+  bool m_snrAided; ///< whether the SNR average can make the rate jump several steps
+  double m_snrAlpha; ///< weight of a new SNR report in the SNR average
+  double m_snrMargin; ///< SNR margin (dB) above the threshold of a rate before jumping to it
+  double m_snrMarginRatio; ///< m_snrMargin as a linear ratio
+  double m_snrBer; ///< target BER the SNR thresholds of the ladder are computed for
+  bool m_fastStart; ///< whether the first SNR report of a station seeds its rate
+  std::string m_fastStartTableString; ///< FastStartSnrTable attribute, "snrDb:index" pairs
+  std::string m_fastStartTableParsed; ///< value of m_fastStartTableString m_fastStartTable was parsed from
+  std::vector<std::pair<double, uint32_t> > m_fastStartTable; ///< (SNR (linear), rate index) pairs, by increasing SNR
+  bool m_lossWindowMode; ///< whether decisions are taken on the loss ratio of a window of outcomes
+  uint32_t m_lossWindowSize; ///< number of outcomes in the loss window
+  double m_lossWindowRaiseThreshold; ///< loss ratio of a full window at or below which the rate goes up
+  double m_lossWindowLowerThreshold; ///< loss ratio of the window at or above which the rate goes down
+  uint32_t m_finalFailureSteps; ///< rates to fall back when a packet is dropped
+  uint32_t m_finalFailureFloor; ///< highest rate index a station keeps when a packet is dropped
+  uint32_t m_finalFailureHoldOff; ///< successes without rate increase after a packet is dropped
+  bool m_collisionAwareRts; ///< whether failures without protection turn RTS/CTS on
+  uint32_t m_protectionSuccessThreshold; ///< successes before RTS/CTS protection is turned off
+  std::vector<WifiMode> m_rtsModes; ///< basic modes the RTS rate controller walks through
+  uint32_t m_rtsModesNBasic; ///< size of the BasicRateSet m_rtsModes was built from
+  bool m_rtsModesNonErpProtection; ///< non-ERP protection setting m_rtsModes was built for
+  bool m_rtsModesValid; ///< whether m_rtsModes has been built
+
+  std::list<ArfRateLadder> m_ladders; ///< rate ladders shared between stations
+
+  uint32_t m_rateMemorySize; ///< maximum number of peers in the rate memory
+  Time m_rateMemoryLifetime; ///< age after which a rate memory entry is not used anymore
+  std::list<ArfRateMemoryEntry> m_rateMemory; ///< rate memory, most recently used first
+  /// rate memory entries by peer address
+  std::map<Mac48Address, std::list<ArfRateMemoryEntry>::iterator> m_rateMemoryIndex;
+
+  bool m_statistics; ///< whether rate control statistics are kept per station
+  ArfFamilyStationPool *m_statsPool; ///< pool of the statistics of the stations
+  ArfFamilyStatsRecord *m_statsRecords; ///< sentinel of the circular list of the statistics of the live stations
+  Ptr<OutputStreamWrapper> m_statsStream; ///< stream the statistics are dumped to
+  Time m_statsInterval; ///< interval between two dumps of the statistics
+  EventId m_statsEvent; ///< next dump of the statistics
+};
+
+template <class Policy>
+template <class State>
+void
+ArfFamilyRateControl<Policy>::InitState (State &state) const
+{
+  state.SetSuccessThreshold (Policy::GetInitialSuccessThreshold ());
+  state.SetTimerTimeout (Policy::GetInitialTimerTimeout ());
+  state.SetRate (0);
+  state.ResetSuccess ();
+  state.ResetFailed ();
+  state.SetRecovery (false);
+  state.ResetRetry ();
+  state.ResetTimer ();
+}
+
+template <class Policy>
+template <class State>
+inline bool
+ArfFamilyRateControl<Policy>::UpdateOnDataOk (State &state, uint32_t nRates) const
+{
+  //UpdateOnSuccess spelled out for a single success, the most frequent transition
+  state.IncrementTimer ();
+  state.IncrementSuccess ();
+  state.ResetFailed ();
+  state.SetRecovery (false);
+  state.ResetRetry ();
+  if ((state.GetSuccess () >= Policy::GetSuccessThreshold (state.GetSuccessThreshold ())
+       || state.GetTimer () == Policy::GetTimerTimeout (state.GetTimerTimeout ()))
+      && state.GetRate () + 1 < nRates)
+    {
+      state.SetRate (state.GetRate () + 1);
+      state.ResetTimer ();
+      state.ResetSuccess ();
+      state.SetRecovery (true);
+      return true;
+    }
+  return false;
+}
+
+template <class Policy>
+template <class State>
+inline bool
+ArfFamilyRateControl<Policy>::UpdateOnDataOk (State &state, uint32_t nRates, bool timerExpired) const
+{
+  state.IncrementTimer ();
+  return UpdateOnSuccess (state, 1, timerExpired, nRates);
+}
+
+template <class Policy>
+template <class State>
+inline bool
+ArfFamilyRateControl<Policy>::UpdateOnDataFailed (State &state) const
+{
+  state.IncrementTimer ();
+  state.IncrementFailed ();
+  state.IncrementRetry ();
+  state.ResetSuccess ();
+
+  uint32_t retry = state.GetRetry ();
+  uint32_t successThreshold;
+  uint32_t timerTimeout;
+  if (state.GetRecovery ())
+    {
+      //the probe of a new rate failed: fall back at once
+      state.ResetTimer ();
+      if (retry != 1)
+        {
+          return false;
+        }
+      successThreshold = state.GetSuccessThreshold ();
+      timerTimeout = state.GetTimerTimeout ();
+      Policy::RecoveryFallback (successThreshold, timerTimeout);
+    }
+  else
+    {
+      //fall back on every second consecutive failure
+      if (retry >= 2)
+        {
+          state.ResetTimer ();
+        }
+      if ((retry & 1) != 0)
+        {
+          return false;
+        }
+      successThreshold = state.GetSuccessThreshold ();
+      timerTimeout = state.GetTimerTimeout ();
+      Policy::NormalFallback (successThreshold, timerTimeout);
+    }
+  state.SetSuccessThreshold (successThreshold);
+  state.SetTimerTimeout (timerTimeout);
+  if (state.GetRate () != 0)
+    {
+      state.SetRate (state.GetRate () - 1);
+      return true;
+    }
+  return false;
+}
+
+template <class Policy>
+template <class State>
+inline bool
+ArfFamilyRateControl<Policy>::UpdateOnAggregate (State &state, uint32_t nSuccess, uint32_t nFailed, uint32_t nRates) const
+{
+  if (IsAggregateFailed (nSuccess, nFailed))
+    {
+      return UpdateOnDataFailed (state);
+    }
+  state.AddTimer (nSuccess + nFailed);
+  return UpdateOnSuccess (state, (nFailed == 0) * nSuccess,
+                          state.GetTimer () >= Policy::GetTimerTimeout (state.GetTimerTimeout ()), nRates);
+}
+
+template <class Policy>
+template <class State>
+inline bool
+ArfFamilyRateControl<Policy>::UpdateOnAggregate (State &state, uint32_t nSuccess, uint32_t nFailed, uint32_t nRates,
+                                                 bool timerExpired) const
+{
+  if (IsAggregateFailed (nSuccess, nFailed))
+    {
+      return UpdateOnDataFailed (state);
+    }
+  state.AddTimer (nSuccess + nFailed);
+  return UpdateOnSuccess (state, (nFailed == 0) * nSuccess, timerExpired, nRates);
+}
+
+template <class Policy>
+template <class State>
+inline bool
+ArfFamilyRateControl<Policy>::UpdateOnSuccess (State &state, uint32_t nSuccess, bool timerExpired, uint32_t nRates) const
+{
+  if (nSuccess == 0)
+    {
+      state.ResetSuccess ();
+    }
+  else
+    {
+      state.AddSuccess (nSuccess);
+    }
+  state.ResetFailed ();
+  state.SetRecovery (false);
+  state.ResetRetry ();
+  if ((state.GetSuccess () >= Policy::GetSuccessThreshold (state.GetSuccessThreshold ()) || timerExpired)
+      && state.GetRate () + 1 < nRates)
+    {
+      state.SetRate (state.GetRate () + 1);
+      state.ResetTimer ();
+      state.ResetSuccess ();
+      state.SetRecovery (true);
+      return true;
+    }
+  return false;
+}
+
+template <class Policy>
+template <class State>
+bool
+ArfFamilyRateControl<Policy>::JumpToRate (State &state, uint32_t rate) const
+{
+  if (rate == state.GetRate ())
+    {
+      return false;
+    }
+  state.SetRecovery (rate > state.GetRate ());
+  state.SetRate (rate);
+  state.ResetTimer ();
+  state.ResetSuccess ();
+  state.ResetFailed ();
+  state.ResetRetry ();
+  return true;
+}
+
+template <class Policy>
+template <class State>
+bool
+ArfFamilyRateControl<Policy>::FallBackTo (State &state, uint32_t rate) const
+{
+  uint32_t successThreshold = state.GetSuccessThreshold ();
+  uint32_t timerTimeout = state.GetTimerTimeout ();
+  Policy::NormalFallback (successThreshold, timerTimeout);
+  state.SetSuccessThreshold (successThreshold);
+  state.SetTimerTimeout (timerTimeout);
+  return JumpToRate (state, rate);
+}
+
+} //namespace ns3
+
+#endif /* ARF_FAMILY_WIFI_MANAGER_H */
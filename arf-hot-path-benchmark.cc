@@ -0,0 +1,441 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Microbenchmark of the ARF/AARF hot path at 1 to 100k stations.
+ *
+ * For each manager (ArfWifiManager, AarfWifiManager), state
+ * representation (CompactStationState off and on), outcome model
+ * (ArfIidOutcomeModel, ArfGilbertElliottOutcomeModel,
+ * ArfSnrRampOutcomeModel) and station count (1, 10, ..., MaxStations), an
+ * 802.11a manager is driven as the MAC drives it, over stations visited
+ * round-robin: each transmission asks GetDataTxVector for the tx vector,
+ * draws the outcome at the rate index of its mode from the model and
+ * reports it with ReportDataOk or ReportDataFailed.
+ *
+ * Every station makes at least 100 transmissions, so that the rates have
+ * settled for most of the run. Two more passes are timed and subtracted:
+ * - drawing outcomes costs more than the manager, so the same rates are
+ *   replayed through a new model using the same stream;
+ * - the station lookup of the base class is a linear scan of all the
+ *   stations in this version of ns-3, which dominates at large station
+ *   counts: it is timed with two ReportFinalRtsFailed calls per
+ *   transmission, which only test the station for an extension beyond
+ *   the lookup.
+ * The report gives per configuration:
+ * - ns per transmission with all the calls, and the lookup part of it;
+ * - ns per transmission and transmissions/sec of the manager itself;
+ * - last level cache misses per transmission, lookup and model excluded,
+ *   read with perf_event_open on Linux ("n/a" elsewhere or when the
+ *   kernel does not allow it);
+ * - heap bytes per station: the growth of the heap in use from before
+ *   the stations are added to after their first transmission, divided by
+ *   the station count. It covers everything allocated for a peer: the
+ *   station state of the base class and its supported modes, the station
+ *   and its slot in the pool, the optional extension and the base class
+ *   vectors. At small counts it is dominated by the first slab of the
+ *   pool. It needs glibc ("n/a" elsewhere);
+ * - the ratio of successful outcomes, to check the model settings.
+ *
+ * The default largest count is 100k. Because of the linear lookup its
+ * runs take much longer than all the smaller counts together; a quick run
+ * can stop earlier with e.g. --maxStations=10000.
+ *
+ * The program links with the ns-3 core, network and wifi modules:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-hot-path-benchmark.cc
+ *       arf-outcome-model.cc -L<ns-3 lib dir> -l<wifi lib> -l<network lib>
+ *       -l<core lib>
+ *
+ * where the library names depend on the version and build profile of
+ * ns-3, e.g. ns3.28-wifi-optimized for an optimized ns-3.28 build.
+ *
+ * The models are configured through their attributes on the command
+ * line, e.g. --ns3::ArfGilbertElliottOutcomeModel::BadLossProbability=0.5
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "ns3/boolean.h"
+#include "ns3/command-line.h"
+#include "ns3/packet.h"
+#include "aarf-wifi-manager.h"
+#include "arf-outcome-model.h"
+#include "arf-wifi-manager.h"
+#include "wifi-mac-header.h"
+#include "yans-wifi-phy.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief counter of the last level cache misses of the calling thread
+ */
+class CacheMissCounter
+{
+public:
+  CacheMissCounter ()
+    : m_fd (-1)
+  {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    std::memset (&attr, 0, sizeof (attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof (attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    m_fd = static_cast<int> (syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+  ~CacheMissCounter ()
+  {
+#ifdef __linux__
+    if (m_fd >= 0)
+      {
+        close (m_fd);
+      }
+#endif
+  }
+  /**
+   * \return true if the counter can be read
+   */
+  bool IsAvailable (void) const
+  {
+    return m_fd >= 0;
+  }
+  /**
+   * Reset the counter and start counting.
+   */
+  void Start (void)
+  {
+#ifdef __linux__
+    if (m_fd >= 0)
+      {
+        ioctl (m_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl (m_fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+#endif
+  }
+  /**
+   * Stop counting.
+   *
+   * \return the misses since Start, 0 if the counter is not available
+   */
+  uint64_t Stop (void)
+  {
+    uint64_t count = 0;
+#ifdef __linux__
+    if (m_fd >= 0)
+      {
+        ioctl (m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read (m_fd, &count, sizeof (count)) != sizeof (count))
+          {
+            count = 0;
+          }
+      }
+#endif
+    return count;
+  }
+
+private:
+  int m_fd; ///< perf event file descriptor, -1 if not available
+};
+
+/**
+ * \return the bytes of heap in use, 0 if unknown
+ */
+uint64_t
+GetHeapInUse (void)
+{
+#if defined (__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2 ();
+  return info.uordblks + info.hblkhd;
+#elif defined (__GLIBC__)
+  struct mallinfo info = mallinfo ();
+  return static_cast<uint32_t> (info.uordblks) + static_cast<uint32_t> (info.hblkhd);
+#else
+  return 0;
+#endif
+}
+
+/**
+ * \param name iid, gilbert-elliott or snr-ramp
+ * \return a new model of that kind, with its attributes set from the defaults
+ */
+Ptr<ArfOutcomeModel>
+CreateModel (const std::string &name)
+{
+  Ptr<ArfOutcomeModel> model;
+  if (name == "iid")
+    {
+      model = CreateObject<ArfIidOutcomeModel> ();
+    }
+  else if (name == "gilbert-elliott")
+    {
+      model = CreateObject<ArfGilbertElliottOutcomeModel> ();
+    }
+  else
+    {
+      model = CreateObject<ArfSnrRampOutcomeModel> ();
+    }
+  model->AssignStreams (1);
+  return model;
+}
+
+/**
+ * Run one configuration and print its line of the report.
+ *
+ * \param policy arf or aarf
+ * \param compact whether the stations use the compact state
+ * \param modelName the outcome model, see CreateModel
+ * \param nStations the number of stations
+ * \param nCalls the minimum number of transmissions, rounded up to a
+ *        multiple of nStations and to at least 100 per station
+ * \param counter the cache miss counter
+ */
+void
+Run (const std::string &policy, bool compact, const std::string &modelName, uint32_t nStations,
+     uint64_t nCalls, CacheMissCounter &counter)
+{
+  uint64_t nRounds = std::max<uint64_t> ((nCalls + nStations - 1) / nStations, 100);
+  nCalls = nRounds * nStations;
+
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  //rate index of each mode, by mode uid
+  std::vector<uint8_t> rateOfUid;
+  for (uint8_t i = 0; i < phy->GetNModes (); i++)
+    {
+      uint32_t uid = phy->GetMode (i).GetUid ();
+      if (uid >= rateOfUid.size ())
+        {
+          rateOfUid.resize (uid + 1, 0);
+        }
+      rateOfUid[uid] = i;
+    }
+  Ptr<WifiRemoteStationManager> manager;
+  if (policy == "arf")
+    {
+      manager = CreateObject<ArfWifiManager> ();
+    }
+  else
+    {
+      manager = CreateObject<AarfWifiManager> ();
+    }
+  manager->SetAttribute ("CompactStationState", BooleanValue (compact));
+  manager->SetupPhy (phy);
+
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_DATA);
+  Ptr<Packet> packet = Create<Packet> (1000);
+  std::vector<Mac48Address> stations;
+  stations.reserve (nStations);
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      stations.push_back (Mac48Address::Allocate ());
+    }
+  std::vector<uint8_t> rates (nCalls);
+  Ptr<ArfOutcomeModel> model = CreateModel (modelName);
+
+  //per-station memory, first transmission included
+  uint64_t heapBefore = GetHeapInUse ();
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      manager->AddAllSupportedModes (stations[i]);
+      manager->RecordGotAssocTxOk (stations[i]);
+      WifiMode mode = manager->GetDataTxVector (stations[i], &header, packet).GetMode ();
+      manager->ReportDataOk (stations[i], &header, 20, mode, 20);
+    }
+  uint64_t heapAfter = GetHeapInUse ();
+
+  //manager, lookups and model
+  uint64_t k = 0;
+  counter.Start ();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint64_t r = 0; r < nRounds; r++)
+    {
+      for (uint32_t i = 0; i < nStations; i++)
+        {
+          WifiMode mode = manager->GetDataTxVector (stations[i], &header, packet).GetMode ();
+          uint8_t rate = rateOfUid[mode.GetUid ()];
+          rates[k++] = rate;
+          if (model->IsSuccess (i, rate))
+            {
+              manager->ReportDataOk (stations[i], &header, 20, mode, 20);
+            }
+          else
+            {
+              manager->ReportDataFailed (stations[i], &header);
+            }
+        }
+    }
+  double total = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  uint64_t totalMisses = counter.Stop ();
+
+  //model alone, on the same rates
+  model = CreateModel (modelName);
+  uint64_t nSuccess = 0;
+  k = 0;
+  counter.Start ();
+  start = std::chrono::steady_clock::now ();
+  for (uint64_t r = 0; r < nRounds; r++)
+    {
+      for (uint32_t i = 0; i < nStations; i++)
+        {
+          nSuccess += model->IsSuccess (i, rates[k++]);
+        }
+    }
+  double drawing = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  uint64_t drawingMisses = counter.Stop ();
+
+  //lookups alone, two per transmission
+  counter.Start ();
+  start = std::chrono::steady_clock::now ();
+  for (uint64_t r = 0; r < nRounds; r++)
+    {
+      for (uint32_t i = 0; i < nStations; i++)
+        {
+          manager->ReportFinalRtsFailed (stations[i], &header);
+          manager->ReportFinalRtsFailed (stations[i], &header);
+        }
+    }
+  double lookup = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  uint64_t lookupMisses = counter.Stop ();
+  manager->Dispose ();
+  phy->Dispose ();
+
+  double seconds = std::max (total - drawing - lookup, 0.0);
+  std::cout << std::left << std::setw (14) << (compact ? policy + " compact" : policy)
+            << std::setw (16) << modelName
+            << std::right << std::setw (8) << nStations
+            << std::fixed << std::setprecision (1)
+            << std::setw (11) << std::max (total - drawing, 0.0) * 1e9 / nCalls
+            << std::setw (11) << lookup * 1e9 / nCalls
+            << std::setw (10) << seconds * 1e9 / nCalls
+            << std::setw (10) << ((seconds > 0) ? nCalls / seconds / 1e6 : 0.0);
+  if (counter.IsAvailable ())
+    {
+      double misses = static_cast<double> (totalMisses) - drawingMisses - lookupMisses;
+      std::cout << std::setprecision (3) << std::setw (12) << std::max (misses, 0.0) / nCalls;
+    }
+  else
+    {
+      std::cout << std::setw (12) << "n/a";
+    }
+  if (heapAfter > 0)
+    {
+      std::cout << std::setprecision (0) << std::setw (10)
+                << (static_cast<double> (heapAfter) - heapBefore) / nStations;
+    }
+  else
+    {
+      std::cout << std::setw (10) << "n/a";
+    }
+  std::cout << std::setprecision (3) << std::setw (9) << static_cast<double> (nSuccess) / nCalls
+            << std::endl;
+}
+
+/**
+ * Run all the station counts and models of one manager and state.
+ *
+ * \param policy arf or aarf
+ * \param compact whether the stations use the compact state
+ * \param models the outcome models to use
+ * \param maxStations the largest station count
+ * \param nCalls the minimum number of transmissions per configuration
+ * \param counter the cache miss counter
+ */
+void
+RunAll (const std::string &policy, bool compact, const std::vector<std::string> &models,
+        uint32_t maxStations, uint64_t nCalls, CacheMissCounter &counter)
+{
+  for (uint32_t m = 0; m < models.size (); m++)
+    {
+      for (uint32_t n = 1; n <= maxStations; n *= 10)
+        {
+          Run (policy, compact, models[m], n, nCalls, counter);
+        }
+    }
+}
+
+} //anonymous namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t maxStations = 100000;
+  uint64_t nCalls = 2000000;
+  std::string policy = "all";
+  std::string model = "all";
+  CommandLine cmd;
+  cmd.AddValue ("maxStations", "The largest station count, counts go from 1 by powers of 10", maxStations);
+  cmd.AddValue ("calls", "The minimum number of transmissions per configuration, at least 100 per station", nCalls);
+  cmd.AddValue ("policy", "The rate control: arf, aarf or all", policy);
+  cmd.AddValue ("model", "The outcome model: iid, gilbert-elliott, snr-ramp or all", model);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> models;
+  if (model == "all")
+    {
+      models.push_back ("iid");
+      models.push_back ("gilbert-elliott");
+      models.push_back ("snr-ramp");
+    }
+  else
+    {
+      models.push_back (model);
+    }
+
+  CacheMissCounter counter;
+  std::cout << std::left << std::setw (14) << "control"
+            << std::setw (16) << "model"
+            << std::right << std::setw (8) << "stations"
+            << std::setw (11) << "ns/tx"
+            << std::setw (11) << "lookup ns"
+            << std::setw (10) << "net ns"
+            << std::setw (10) << "Mtx/s"
+            << std::setw (12) << "misses/tx"
+            << std::setw (10) << "B/sta"
+            << std::setw (9) << "success" << std::endl;
+  if (policy == "all" || policy == "arf")
+    {
+      RunAll ("arf", false, models, maxStations, nCalls, counter);
+      RunAll ("arf", true, models, maxStations, nCalls, counter);
+    }
+  if (policy == "all" || policy == "aarf")
+    {
+      RunAll ("aarf", false, models, maxStations, nCalls, counter);
+      RunAll ("aarf", true, models, maxStations, nCalls, counter);
+    }
+  return 0;
+}
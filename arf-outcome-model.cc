@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "arf-outcome-model.h"
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/unused.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ArfOutcomeModel");
+
+NS_OBJECT_ENSURE_REGISTERED (ArfOutcomeModel);
+NS_OBJECT_ENSURE_REGISTERED (ArfIidOutcomeModel);
+NS_OBJECT_ENSURE_REGISTERED (ArfGilbertElliottOutcomeModel);
+NS_OBJECT_ENSURE_REGISTERED (ArfSnrRampOutcomeModel);
+
+double
+ArfLogisticSuccessProbability (double margin, double spread)
+{
+  if (spread > 0)
+    {
+      return 1 / (1 + std::exp (-margin / spread));
+    }
+  return (margin >= 0) ? 1 : 0;
+}
+
+TypeId
+ArfOutcomeModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ArfOutcomeModel")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+  ;
+  return tid;
+}
+
+ArfOutcomeModel::ArfOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+  m_uniform = CreateObject<UniformRandomVariable> ();
+}
+
+ArfOutcomeModel::~ArfOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+int64_t
+ArfOutcomeModel::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uniform->SetStream (stream);
+  return 1;
+}
+
+TypeId
+ArfIidOutcomeModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ArfIidOutcomeModel")
+    .SetParent<ArfOutcomeModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<ArfIidOutcomeModel> ()
+    .AddAttribute ("LossProbability",
+                   "The loss probability at the lowest rate.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&ArfIidOutcomeModel::m_lossProbability),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("LossIncrement",
+                   "The increase of the loss probability per rate index.",
+                   DoubleValue (0.04),
+                   MakeDoubleAccessor (&ArfIidOutcomeModel::m_lossIncrement),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+ArfIidOutcomeModel::ArfIidOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ArfIidOutcomeModel::~ArfIidOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+ArfIidOutcomeModel::IsSuccess (uint32_t station, uint32_t rate)
+{
+  NS_UNUSED (station);
+  return m_uniform->GetValue () >= m_lossProbability + rate * m_lossIncrement;
+}
+
+TypeId
+ArfGilbertElliottOutcomeModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ArfGilbertElliottOutcomeModel")
+    .SetParent<ArfOutcomeModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<ArfGilbertElliottOutcomeModel> ()
+    .AddAttribute ("GoodToBad",
+                   "The probability to move from the good to the bad state before a transmission.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&ArfGilbertElliottOutcomeModel::m_goodToBad),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("BadToGood",
+                   "The probability to move from the bad to the good state before a transmission.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&ArfGilbertElliottOutcomeModel::m_badToGood),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("LossProbability",
+                   "The loss probability at the lowest rate in the good state.",
+                   DoubleValue (0.02),
+                   MakeDoubleAccessor (&ArfGilbertElliottOutcomeModel::m_lossProbability),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("LossIncrement",
+                   "The increase of the loss probability per rate index in the good state.",
+                   DoubleValue (0.02),
+                   MakeDoubleAccessor (&ArfGilbertElliottOutcomeModel::m_lossIncrement),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("BadLossProbability",
+                   "The loss probability in the bad state, at any rate.",
+                   DoubleValue (0.8),
+                   MakeDoubleAccessor (&ArfGilbertElliottOutcomeModel::m_badLossProbability),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+ArfGilbertElliottOutcomeModel::ArfGilbertElliottOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ArfGilbertElliottOutcomeModel::~ArfGilbertElliottOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+ArfGilbertElliottOutcomeModel::IsSuccess (uint32_t station, uint32_t rate)
+{
+  if (station >= m_bad.size ())
+    {
+      m_bad.resize (station + 1, false);
+    }
+  if (m_uniform->GetValue () < (m_bad[station] ? m_badToGood : m_goodToBad))
+    {
+      m_bad[station] = !m_bad[station];
+    }
+  double loss = m_bad[station] ? m_badLossProbability : m_lossProbability + rate * m_lossIncrement;
+  return m_uniform->GetValue () >= loss;
+}
+
+TypeId
+ArfSnrRampOutcomeModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ArfSnrRampOutcomeModel")
+    .SetParent<ArfOutcomeModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<ArfSnrRampOutcomeModel> ()
+    .AddAttribute ("StartSnr",
+                   "The SNR (dB) at the start of the ramp.",
+                   DoubleValue (5),
+                   MakeDoubleAccessor (&ArfSnrRampOutcomeModel::m_startSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("EndSnr",
+                   "The SNR (dB) at the end of the ramp.",
+                   DoubleValue (30),
+                   MakeDoubleAccessor (&ArfSnrRampOutcomeModel::m_endSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("RampLength",
+                   "The number of transmissions from one end of the ramp to the other.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&ArfSnrRampOutcomeModel::m_rampLength),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("FirstRateSnr",
+                   "The SNR (dB) the lowest rate needs.",
+                   DoubleValue (2),
+                   MakeDoubleAccessor (&ArfSnrRampOutcomeModel::m_firstRateSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("RateSnrStep",
+                   "The additional SNR (dB) needed per rate index.",
+                   DoubleValue (3),
+                   MakeDoubleAccessor (&ArfSnrRampOutcomeModel::m_rateSnrStep),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrSpread",
+                   "The width (dB) of the success probability curve around the SNR a rate needs.",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&ArfSnrRampOutcomeModel::m_snrSpread),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+ArfSnrRampOutcomeModel::ArfSnrRampOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ArfSnrRampOutcomeModel::~ArfSnrRampOutcomeModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+ArfSnrRampOutcomeModel::GetSnr (uint32_t station) const
+{
+  uint32_t count = (station < m_count.size ()) ? m_count[station] : 0;
+  uint32_t position = count % (2 * m_rampLength);
+  if (position > m_rampLength)
+    {
+      //on the way back
+      position = 2 * m_rampLength - position;
+    }
+  return m_startSnr + (m_endSnr - m_startSnr) * position / m_rampLength;
+}
+
+bool
+ArfSnrRampOutcomeModel::IsSuccess (uint32_t station, uint32_t rate)
+{
+  double margin = GetSnr (station) - (m_firstRateSnr + rate * m_rateSnrStep);
+  if (station >= m_count.size ())
+    {
+      m_count.resize (station + 1, 0);
+    }
+  m_count[station]++;
+  return m_uniform->GetValue () < ArfLogisticSuccessProbability (margin, m_snrSpread);
+}
+
+} //namespace ns3
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARF_OUTCOME_MODEL_H
+#define ARF_OUTCOME_MODEL_H
+
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * Success probability of a transmission as a logistic function of the
+ * margin of its SNR over the threshold of its rate, shared by the
+ * outcome models and the rate control replay.
+ *
+ * \param margin the SNR of the transmission minus the threshold of its rate (dB)
+ * \param spread the width of the curve (dB), 0 for a step at the threshold
+ * \return the success probability
+ */
+double ArfLogisticSuccessProbability (double margin, double spread);
+
+/**
+ * \ingroup wifi
+ * \brief synthetic stream of transmission outcomes
+ *
+ * Outcome models draw the success or failure of the transmissions of a
+ * set of stations at a given rate index, without a PHY or a channel.
+ * They drive the ARF family rate controls outside of a full simulation,
+ * e.g. to measure or tune them. Each call advances the stream of the
+ * station, so that models with memory (bursts, SNR ramps) evolve per
+ * station.
+ */
+class ArfOutcomeModel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  ArfOutcomeModel ();
+  virtual ~ArfOutcomeModel ();
+
+  /**
+   * Draw the outcome of the next transmission of a station.
+   *
+   * \param station the index of the station
+   * \param rate the rate index the transmission is made at
+   * \return true if the transmission succeeds
+   */
+  virtual bool IsSuccess (uint32_t station, uint32_t rate) = 0;
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  Ptr<UniformRandomVariable> m_uniform; //!< random variable the outcomes are drawn from
+};
+
+/**
+ * \ingroup wifi
+ * \brief independent losses, more likely at higher rates
+ *
+ * The loss probability of a transmission at rate index i is
+ * LossProbability + i * LossIncrement.
+ */
+class ArfIidOutcomeModel : public ArfOutcomeModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  ArfIidOutcomeModel ();
+  virtual ~ArfIidOutcomeModel ();
+
+  bool IsSuccess (uint32_t station, uint32_t rate);
+
+private:
+  double m_lossProbability; ///< loss probability at the lowest rate
+  double m_lossIncrement; ///< increase of the loss probability per rate index
+};
+
+/**
+ * \ingroup wifi
+ * \brief bursty losses from a two-state Gilbert-Elliott channel
+ *
+ * Each station has its own channel, which moves between a good and a bad
+ * state before each transmission. In the good state losses are as in
+ * ArfIidOutcomeModel, in the bad state they happen with BadLossProbability
+ * at any rate.
+ */
+class ArfGilbertElliottOutcomeModel : public ArfOutcomeModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  ArfGilbertElliottOutcomeModel ();
+  virtual ~ArfGilbertElliottOutcomeModel ();
+
+  bool IsSuccess (uint32_t station, uint32_t rate);
+
+private:
+  double m_goodToBad; ///< probability to move from the good to the bad state
+  double m_badToGood; ///< probability to move from the bad to the good state
+  double m_lossProbability; ///< loss probability at the lowest rate in the good state
+  double m_lossIncrement; ///< increase of the loss probability per rate index in the good state
+  double m_badLossProbability; ///< loss probability in the bad state
+  std::vector<bool> m_bad; ///< state of the channel of each station
+};
+
+/**
+ * \ingroup wifi
+ * \brief losses driven by an SNR ramping up and down
+ *
+ * The SNR of each station goes from StartSnr to EndSnr over RampLength
+ * transmissions, then back, and so on. Rate index i needs
+ * FirstRateSnr + i * RateSnrStep, and the success probability follows a
+ * logistic curve of width SnrSpread around that threshold.
+ */
+class ArfSnrRampOutcomeModel : public ArfOutcomeModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  ArfSnrRampOutcomeModel ();
+  virtual ~ArfSnrRampOutcomeModel ();
+
+  bool IsSuccess (uint32_t station, uint32_t rate);
+  /**
+   * \param station the index of the station
+   * \return the SNR (dB) of the next transmission of the station
+   */
+  double GetSnr (uint32_t station) const;
+
+private:
+  double m_startSnr; ///< SNR (dB) at the start of the ramp
+  double m_endSnr; ///< SNR (dB) at the end of the ramp
+  uint32_t m_rampLength; ///< number of transmissions from one end of the ramp to the other
+  double m_firstRateSnr; ///< SNR (dB) needed by the lowest rate
+  double m_rateSnrStep; ///< additional SNR (dB) needed per rate index
+  double m_snrSpread; ///< width (dB) of the success probability curve
+  std::vector<uint32_t> m_count; ///< transmissions of each station so far
+};
+
+} //namespace ns3
+
+#endif /* ARF_OUTCOME_MODEL_H */
@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "arf-parameter-sweep.h"
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ArfParameterSweep");
+
+/**
+ * Queue of configuration indices owned by one worker: the owner pops
+ * from the back, thieves steal from the front.
+ */
+struct ArfSweepQueue
+{
+  std::mutex m_mutex; ///< protects m_indices
+  std::deque<uint32_t> m_indices; ///< configurations left to evaluate
+};
+
+namespace {
+
+/**
+ * \param queue the queue to pop from
+ * \param steal whether to take the oldest index rather than the newest
+ * \param index the popped index
+ * \return whether an index was popped
+ */
+bool
+PopIndex (ArfSweepQueue &queue, bool steal, uint32_t &index)
+{
+  std::lock_guard<std::mutex> lock (queue.m_mutex);
+  if (queue.m_indices.empty ())
+    {
+      return false;
+    }
+  if (steal)
+    {
+      index = queue.m_indices.front ();
+      queue.m_indices.pop_front ();
+    }
+  else
+    {
+      index = queue.m_indices.back ();
+      queue.m_indices.pop_back ();
+    }
+  return true;
+}
+
+/**
+ * Order sweep results by decreasing goodput.
+ *
+ * \param a the first result
+ * \param b the second result
+ * \return true if the goodput of a is higher than the goodput of b
+ */
+template <class Policy>
+bool
+IsHigherGoodput (const ArfSweepResult<Policy> &a, const ArfSweepResult<Policy> &b)
+{
+  return a.m_goodput > b.m_goodput;
+}
+
+} //anonymous namespace
+
+template <class Policy>
+ArfParameterSweep<Policy>::ArfParameterSweep (const std::vector<ArfReplayRecord> &records,
+                                              const std::vector<uint64_t> &dataRates,
+                                              const std::vector<double> &snrThresholds)
+  : m_records (records),
+    m_dataRates (dataRates),
+    m_snrThresholds (snrThresholds),
+    m_snrSpread (1),
+    m_frameOverhead (0),
+    m_seed (1),
+    m_goodputTolerance (0.01)
+{
+  NS_LOG_FUNCTION (this << records.size ());
+}
+
+template <class Policy>
+void
+ArfParameterSweep<Policy>::AddConfiguration (const ArfFamilyRateControl<Policy> &configuration)
+{
+  m_configurations.push_back (configuration);
+}
+
+template <class Policy>
+uint32_t
+ArfParameterSweep<Policy>::GetNConfigurations (void) const
+{
+  return m_configurations.size ();
+}
+
+template <class Policy>
+void
+ArfParameterSweep<Policy>::SetReplayParameters (double spread, double overhead, uint32_t seed)
+{
+  m_snrSpread = spread;
+  m_frameOverhead = overhead;
+  m_seed = seed;
+}
+
+template <class Policy>
+void
+ArfParameterSweep<Policy>::SetGoodputTolerance (double tolerance)
+{
+  m_goodputTolerance = tolerance;
+}
+
+template <class Policy>
+ArfSweepResult<Policy>
+ArfParameterSweep<Policy>::Evaluate (const ArfFamilyRateControl<Policy> &configuration) const
+{
+  //Every configuration gets its own replay, hence its own station states
+  //and random stream: workers only share the read-only records.
+  ArfRateControlReplay<Policy> replay (configuration, m_dataRates, m_snrThresholds);
+  replay.SetSnrSpread (m_snrSpread);
+  replay.SetFrameOverhead (m_frameOverhead);
+  replay.SetSeed (m_seed);
+  ArfReplayResult replayed = replay.Run (m_records, false);
+  ArfSweepResult<Policy> result;
+  result.m_configuration = configuration;
+  result.m_goodput = replayed.GetGoodput ();
+  result.m_convergenceTime = replayed.m_convergenceTime;
+  return result;
+}
+
+template <class Policy>
+std::vector<ArfSweepResult<Policy> >
+ArfParameterSweep<Policy>::Run (uint32_t nThreads) const
+{
+  NS_LOG_FUNCTION (this << nThreads);
+  uint32_t nConfigurations = m_configurations.size ();
+  std::vector<ArfSweepResult<Policy> > results (nConfigurations);
+  if (nConfigurations == 0)
+    {
+      return results;
+    }
+  if (nThreads == 0)
+    {
+      nThreads = std::max (std::thread::hardware_concurrency (), 1u);
+    }
+  nThreads = std::min (nThreads, nConfigurations);
+
+  //Deal the configurations round-robin, so that neighbouring grid points,
+  //which tend to cost the same, land on different workers.
+  std::vector<ArfSweepQueue> queues (nThreads);
+  for (uint32_t i = 0; i < nConfigurations; i++)
+    {
+      queues[i % nThreads].m_indices.push_back (i);
+    }
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < nThreads; i++)
+    {
+      threads.push_back (std::thread (&ArfParameterSweep<Policy>::Work, this,
+                                      std::ref (queues), std::ref (results), i));
+    }
+  Work (queues, results, 0);
+  for (std::vector<std::thread>::iterator i = threads.begin (); i != threads.end (); i++)
+    {
+      i->join ();
+    }
+
+  //Rank greedily: the next result is the one converging fastest among the
+  //results left whose goodput is within the tolerance of the best goodput
+  //left. Each pair is compared against the tolerance itself, which a sort
+  //cannot do since "within the tolerance" is not transitive.
+  std::stable_sort (results.begin (), results.end (), IsHigherGoodput<Policy>);
+  double tolerance = results.front ().m_goodput * m_goodputTolerance;
+  std::vector<ArfSweepResult<Policy> > ranked;
+  ranked.reserve (nConfigurations);
+  while (!results.empty ())
+    {
+      typename std::vector<ArfSweepResult<Policy> >::iterator next = results.begin ();
+      for (typename std::vector<ArfSweepResult<Policy> >::iterator i = results.begin ();
+           i != results.end () && results.front ().m_goodput - i->m_goodput <= tolerance; i++)
+        {
+          if (i->m_convergenceTime < next->m_convergenceTime)
+            {
+              next = i;
+            }
+        }
+      ranked.push_back (*next);
+      results.erase (next);
+    }
+  return ranked;
+}
+
+template <class Policy>
+void
+ArfParameterSweep<Policy>::Work (std::vector<ArfSweepQueue> &queues,
+                                 std::vector<ArfSweepResult<Policy> > &results, uint32_t self) const
+{
+  //No configuration is ever added back, so a worker that finds every
+  //queue empty can stop. Each result slot is written by exactly one worker.
+  uint32_t nThreads = queues.size ();
+  uint32_t index;
+  while (true)
+    {
+      bool found = PopIndex (queues[self], false, index);
+      for (uint32_t i = 1; !found && i < nThreads; i++)
+        {
+          found = PopIndex (queues[(self + i) % nThreads], true, index);
+        }
+      if (!found)
+        {
+          return;
+        }
+      results[index] = Evaluate (m_configurations[index]);
+    }
+}
+
+void
+AddGrid (ArfParameterSweep<ArfThresholdPolicy> &sweep,
+         const std::vector<uint32_t> &timerThresholds,
+         const std::vector<uint32_t> &successThresholds)
+{
+  ArfFamilyRateControl<ArfThresholdPolicy> configuration;
+  for (std::vector<uint32_t>::const_iterator t = timerThresholds.begin (); t != timerThresholds.end (); t++)
+    {
+      for (std::vector<uint32_t>::const_iterator s = successThresholds.begin (); s != successThresholds.end (); s++)
+        {
+          configuration.m_timerThreshold = *t;
+          configuration.m_successThreshold = *s;
+          sweep.AddConfiguration (configuration);
+        }
+    }
+}
+
+void
+AddGrid (ArfParameterSweep<AarfThresholdPolicy> &sweep,
+         const std::vector<double> &successKs,
+         const std::vector<double> &timerKs,
+         const std::vector<uint32_t> &maxSuccessThresholds,
+         const std::vector<uint32_t> &minTimerThresholds,
+         const std::vector<uint32_t> &minSuccessThresholds)
+{
+  ArfFamilyRateControl<AarfThresholdPolicy> configuration;
+  for (std::vector<double>::const_iterator sk = successKs.begin (); sk != successKs.end (); sk++)
+    {
+      for (std::vector<double>::const_iterator tk = timerKs.begin (); tk != timerKs.end (); tk++)
+        {
+          for (std::vector<uint32_t>::const_iterator ms = maxSuccessThresholds.begin (); ms != maxSuccessThresholds.end (); ms++)
+            {
+              for (std::vector<uint32_t>::const_iterator mt = minTimerThresholds.begin (); mt != minTimerThresholds.end (); mt++)
+                {
+                  for (std::vector<uint32_t>::const_iterator s = minSuccessThresholds.begin (); s != minSuccessThresholds.end (); s++)
+                    {
+                      configuration.m_successK = *sk;
+                      configuration.m_timerK = *tk;
+                      configuration.m_maxSuccessThreshold = *ms;
+                      configuration.m_minTimerThreshold = *mt;
+                      configuration.m_minSuccessThreshold = *s;
+                      sweep.AddConfiguration (configuration);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template class ArfParameterSweep<ArfThresholdPolicy>;
+template class ArfParameterSweep<AarfThresholdPolicy>;
+
+} //namespace ns3
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARF_PARAMETER_SWEEP_H
+#define ARF_PARAMETER_SWEEP_H
+
+#include <vector>
+#include "arf-rate-control-replay.h"
+
+namespace ns3 {
+
+struct ArfSweepQueue;
+
+/**
+ * \brief result of one configuration of a parameter sweep
+ */
+template <class Policy>
+struct ArfSweepResult
+{
+  ArfFamilyRateControl<Policy> m_configuration; ///< thresholds of the configuration
+  double m_goodput; ///< goodput (b/s) of the replay
+  double m_convergenceTime; ///< convergence time (s) of the replay
+};
+
+/**
+ * \ingroup wifi
+ * \brief parallel sweep of the ARF or AARF thresholds over a recorded trace
+ *
+ * Each configuration is evaluated by its own ArfRateControlReplay on the
+ * same records, so configurations share nothing but the read-only
+ * records and run on all the local cores. Each worker thread owns a
+ * queue of configurations and steals from the other queues once its own
+ * is empty, which balances the load when some configurations take longer
+ * than others. The results are ranked by goodput, except that among the
+ * configurations whose goodput is within the goodput tolerance of the
+ * best goodput left to rank, the one converging fastest comes first.
+ *
+ * ARF has two tunables (ArfThresholdPolicy) and AARF five
+ * (AarfThresholdPolicy); AddGrid helpers enumerate their cartesian
+ * products.
+ */
+template <class Policy>
+class ArfParameterSweep
+{
+public:
+  /**
+   * \param records the records to replay, in time order, copied by the sweep
+   * \param dataRates the data rate (b/s) of each rate index
+   * \param snrThresholds the SNR (dB) each rate index needs
+   */
+  ArfParameterSweep (const std::vector<ArfReplayRecord> &records,
+                     const std::vector<uint64_t> &dataRates,
+                     const std::vector<double> &snrThresholds);
+
+  /**
+   * \param configuration a configuration to evaluate
+   */
+  void AddConfiguration (const ArfFamilyRateControl<Policy> &configuration);
+  /**
+   * \return the number of configurations to evaluate
+   */
+  uint32_t GetNConfigurations (void) const;
+  /**
+   * \param spread the SNR spread of the success model of the replays
+   * \param overhead the per-frame airtime overhead (s) of the replays
+   * \param seed the seed of the success model of the replays
+   */
+  void SetReplayParameters (double spread, double overhead, uint32_t seed);
+  /**
+   * Goodputs that differ by at most this fraction of the best goodput of
+   * the sweep are considered equal, so that convergence time ranks the
+   * configurations whose goodputs only differ by noise.
+   *
+   * \param tolerance the goodput tolerance, 0.01 by default
+   */
+  void SetGoodputTolerance (double tolerance);
+
+  /**
+   * Evaluate all the configurations.
+   *
+   * \param nThreads the number of worker threads, 0 for one per core
+   * \return the results, best first
+   */
+  std::vector<ArfSweepResult<Policy> > Run (uint32_t nThreads) const;
+
+private:
+  /**
+   * Evaluate one configuration.
+   *
+   * \param configuration the configuration
+   * \return its result
+   */
+  ArfSweepResult<Policy> Evaluate (const ArfFamilyRateControl<Policy> &configuration) const;
+  /**
+   * Evaluate configurations from the queues until they are all empty,
+   * starting with the queue of the worker.
+   *
+   * \param queues the queues of all the workers
+   * \param results the result of each configuration
+   * \param self the index of the queue of the worker
+   */
+  void Work (std::vector<ArfSweepQueue> &queues, std::vector<ArfSweepResult<Policy> > &results,
+             uint32_t self) const;
+
+  std::vector<ArfReplayRecord> m_records; ///< records to replay
+  std::vector<uint64_t> m_dataRates; ///< data rate (b/s) of each rate index
+  std::vector<double> m_snrThresholds; ///< SNR (dB) each rate index needs
+  double m_snrSpread; ///< SNR spread of the success model
+  double m_frameOverhead; ///< per-frame airtime overhead (s)
+  uint32_t m_seed; ///< seed of the success model
+  double m_goodputTolerance; ///< fraction of the best goodput within which goodputs are considered equal
+  std::vector<ArfFamilyRateControl<Policy> > m_configurations; ///< configurations to evaluate
+};
+
+/**
+ * Add the cartesian product of ARF thresholds to a sweep.
+ *
+ * \param sweep the sweep
+ * \param timerThresholds the timer thresholds
+ * \param successThresholds the success thresholds
+ */
+void AddGrid (ArfParameterSweep<ArfThresholdPolicy> &sweep,
+              const std::vector<uint32_t> &timerThresholds,
+              const std::vector<uint32_t> &successThresholds);
+
+/**
+ * Add the cartesian product of AARF parameters to a sweep.
+ *
+ * \param sweep the sweep
+ * \param successKs the success threshold multiplication factors
+ * \param timerKs the timer threshold multiplication factors
+ * \param maxSuccessThresholds the maximum success thresholds
+ * \param minTimerThresholds the minimum timer thresholds
+ * \param minSuccessThresholds the minimum success thresholds
+ */
+void AddGrid (ArfParameterSweep<AarfThresholdPolicy> &sweep,
+              const std::vector<double> &successKs,
+              const std::vector<double> &timerKs,
+              const std::vector<uint32_t> &maxSuccessThresholds,
+              const std::vector<uint32_t> &minTimerThresholds,
+              const std::vector<uint32_t> &minSuccessThresholds);
+
+} //namespace ns3
+
+#endif /* ARF_PARAMETER_SWEEP_H */
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "arf-rate-control-replay.h"
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include "ns3/log.h"
+#include "arf-outcome-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ArfRateControlReplay");
+
+template <class Policy>
+ArfRateControlReplay<Policy>::ArfRateControlReplay (const ArfFamilyRateControl<Policy> &control,
+                                                    const std::vector<uint64_t> &dataRates,
+                                                    const std::vector<double> &snrThresholds)
+  : m_control (control),
+    m_dataRates (dataRates),
+    m_snrThresholds (snrThresholds),
+    m_snrSpread (1),
+    m_frameOverhead (0),
+    m_seed (1)
+{
+  NS_ASSERT (!m_dataRates.empty ());
+  NS_ASSERT (m_dataRates.size () == m_snrThresholds.size ());
+}
+
+template <class Policy>
+void
+ArfRateControlReplay<Policy>::SetSnrSpread (double spread)
+{
+  m_snrSpread = spread;
+}
+
+template <class Policy>
+void
+ArfRateControlReplay<Policy>::SetFrameOverhead (double overhead)
+{
+  m_frameOverhead = overhead;
+}
+
+template <class Policy>
+void
+ArfRateControlReplay<Policy>::SetSeed (uint32_t seed)
+{
+  m_seed = seed;
+}
+
+// Run keeps one ArfFamilyState per station index and feeds it the outcome of each
+// record at the rate it picked. The random number generator is local to the run, so
+// that runs are reproducible and independent of each other. Since ARF keeps probing,
+// the convergence time of a station is the first time it used the rate it used most,
+// and the convergence time of the replay is the latest one over all stations.
+template <class Policy>
+ArfReplayResult
+ArfRateControlReplay<Policy>::Run (const std::vector<ArfReplayRecord> &records, bool trajectory) const
+{
+  ArfReplayResult result;
+  result.m_nFrames = 0;
+  result.m_nSuccess = 0;
+  result.m_successBytes = 0;
+  result.m_airtime = 0;
+  result.m_convergenceTime = 0;
+  if (trajectory)
+    {
+      result.m_trajectory.reserve (records.size ());
+    }
+  std::mt19937 generator (m_seed);
+  std::uniform_real_distribution<double> uniform (0, 1);
+  std::vector<ArfFamilyState> states;
+  uint32_t nRates = m_dataRates.size ();
+  std::vector<uint64_t> rateCounts;
+  std::vector<double> firstUse;
+  for (std::vector<ArfReplayRecord>::const_iterator i = records.begin (); i != records.end (); i++)
+    {
+      NS_ASSERT_MSG (i->m_station < MAX_STATIONS, "station index " << i->m_station << " out of range");
+      while (i->m_station >= states.size ())
+        {
+          states.push_back (ArfFamilyState ());
+          m_control.InitState (states.back ());
+          rateCounts.resize (states.size () * nRates, 0);
+          firstUse.resize (states.size () * nRates, 0);
+        }
+      ArfFamilyState &state = states[i->m_station];
+      uint32_t rate = state.GetRate ();
+      size_t index = static_cast<size_t> (i->m_station) * nRates + rate;
+      if (rateCounts[index]++ == 0)
+        {
+          firstUse[index] = i->m_time;
+        }
+      bool success;
+      if (rate == i->m_rate)
+        {
+          success = i->m_success;
+        }
+      else
+        {
+          double margin = i->m_snr - m_snrThresholds[rate];
+          success = uniform (generator) < ArfLogisticSuccessProbability (margin, m_snrSpread);
+        }
+      if (success)
+        {
+          m_control.UpdateOnDataOk (state, nRates);
+          result.m_nSuccess++;
+          result.m_successBytes += i->m_size;
+        }
+      else
+        {
+          m_control.UpdateOnDataFailed (state);
+        }
+      result.m_nFrames++;
+      result.m_airtime += i->m_size * 8.0 / m_dataRates[rate] + m_frameOverhead;
+      if (trajectory)
+        {
+          ArfReplaySample sample;
+          sample.m_time = i->m_time;
+          sample.m_station = i->m_station;
+          sample.m_rate = rate;
+          sample.m_success = success;
+          result.m_trajectory.push_back (sample);
+        }
+    }
+  for (uint32_t station = 0; station < states.size (); station++)
+    {
+      size_t base = static_cast<size_t> (station) * nRates;
+      uint32_t mostUsed = 0;
+      for (uint32_t rate = 1; rate < nRates; rate++)
+        {
+          if (rateCounts[base + rate] > rateCounts[base + mostUsed])
+            {
+              mostUsed = rate;
+            }
+        }
+      result.m_convergenceTime = std::max (result.m_convergenceTime, firstUse[base + mostUsed]);
+    }
+  return result;
+}
+
+template <class Policy>
+bool
+ArfRateControlReplay<Policy>::Load (std::istream &is, std::vector<ArfReplayRecord> &records)
+{
+  std::string line;
+  while (std::getline (is, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      std::istringstream iss (line);
+      ArfReplayRecord record;
+      uint32_t success;
+      if (!(iss >> record.m_time >> record.m_station >> record.m_size
+            >> record.m_rate >> record.m_snr >> success))
+        {
+          NS_LOG_WARN ("invalid replay record \"" << line << "\"");
+          return false;
+        }
+      if (record.m_station >= MAX_STATIONS)
+        {
+          NS_LOG_WARN ("station index of replay record \"" << line << "\" above " << MAX_STATIONS - 1);
+          return false;
+        }
+      record.m_success = (success != 0);
+      records.push_back (record);
+    }
+  return true;
+}
+
+template class ArfRateControlReplay<ArfThresholdPolicy>;
+template class ArfRateControlReplay<AarfThresholdPolicy>;
+
+} //namespace ns3
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARF_RATE_CONTROL_REPLAY_H
+#define ARF_RATE_CONTROL_REPLAY_H
+
+#include <istream>
+#include <vector>
+#include "arf-family-wifi-manager.h"
+
+namespace ns3 {
+
+/**
+ * \brief one recorded transmission
+ */
+struct ArfReplayRecord
+{
+  double m_time; ///< time of the transmission (s)
+  uint32_t m_station; ///< index of the station
+  uint32_t m_size; ///< frame size (bytes)
+  uint32_t m_rate; ///< rate index the frame was sent at
+  double m_snr; ///< SNR (dB) of the frame
+  bool m_success; ///< whether the frame was acknowledged
+};
+
+/**
+ * \brief one step of the replayed rate trajectory
+ */
+struct ArfReplaySample
+{
+  double m_time; ///< time of the transmission (s)
+  uint32_t m_station; ///< index of the station
+  uint32_t m_rate; ///< rate index picked by the rate control
+  bool m_success; ///< outcome of the transmission at that rate
+};
+
+/**
+ * \brief result of a replay
+ */
+struct ArfReplayResult
+{
+  std::vector<ArfReplaySample> m_trajectory; ///< rate picked for each record, if requested
+  uint64_t m_nFrames; ///< number of replayed frames
+  uint64_t m_nSuccess; ///< number of successful frames
+  uint64_t m_successBytes; ///< bytes of the successful frames
+  double m_airtime; ///< airtime of all the frames (s)
+  double m_convergenceTime; ///< latest time (s) a station first used the rate it used most
+
+  /**
+   * \return the goodput (b/s) over the airtime of the replay
+   */
+  double GetGoodput (void) const
+  {
+    return (m_airtime > 0) ? m_successBytes * 8 / m_airtime : 0;
+  }
+};
+
+/**
+ * \ingroup wifi
+ * \brief replay of recorded transmissions through the ARF family state machine
+ *
+ * The replay runs ArfFamilyRateControl on plain per-station states,
+ * without a simulator, a MAC or a PHY, so that the thresholds of ARF and
+ * AARF can be tuned on recorded traffic much faster than with full
+ * simulations. For each record, the rate control of the station picks a
+ * rate. If it is the recorded rate, the recorded outcome is used;
+ * otherwise the outcome is drawn from a per-rate success model: rate
+ * index i succeeds with a probability following a logistic curve of the
+ * SNR of the record around the SNR threshold of the rate. The airtime of
+ * a frame is its size at the data rate of the rate, plus a fixed
+ * per-frame overhead.
+ *
+ * The replay owns all its state and its random number generator, so
+ * several replays can run in parallel.
+ */
+template <class Policy>
+class ArfRateControlReplay
+{
+public:
+  /**
+   * \param control the rate control to replay, with its thresholds set
+   * \param dataRates the data rate (b/s) of each rate index
+   * \param snrThresholds the SNR (dB) each rate index needs
+   */
+  ArfRateControlReplay (const ArfFamilyRateControl<Policy> &control,
+                        const std::vector<uint64_t> &dataRates,
+                        const std::vector<double> &snrThresholds);
+
+  /**
+   * \param spread the width (dB) of the success probability curve around the
+   *        SNR threshold of a rate
+   */
+  void SetSnrSpread (double spread);
+  /**
+   * \param overhead the airtime (s) added to each frame for preambles,
+   *        ACKs and interframe spaces
+   */
+  void SetFrameOverhead (double overhead);
+  /**
+   * \param seed the seed of the success model
+   */
+  void SetSeed (uint32_t seed);
+
+  /**
+   * Replay a recorded stream.
+   *
+   * \param records the records, in time order
+   * \param trajectory whether to keep the rate picked for each record
+   * \return the result of the replay
+   */
+  ArfReplayResult Run (const std::vector<ArfReplayRecord> &records, bool trajectory) const;
+
+  /**
+   * Read records written one per line as
+   * "time station size rate snr success", with success 0 or 1. Empty lines
+   * and lines starting with '#' are skipped. Station indices must be below
+   * MAX_STATIONS, since the replay keeps the stations in a vector indexed
+   * by them.
+   *
+   * \param is the stream to read from
+   * \param records the vector the records are appended to
+   * \return false if a line could not be parsed or its station index is
+   *         too large
+   */
+  static bool Load (std::istream &is, std::vector<ArfReplayRecord> &records);
+
+  static const uint32_t MAX_STATIONS = 1 << 20; ///< bound on the station indices of the records
+
+private:
+  ArfFamilyRateControl<Policy> m_control; ///< rate control replayed
+  std::vector<uint64_t> m_dataRates; ///< data rate (b/s) of each rate index
+  std::vector<double> m_snrThresholds; ///< SNR (dB) each rate index needs
+  double m_snrSpread; ///< width (dB) of the success probability curve
+  double m_frameOverhead; ///< airtime (s) added to each frame
+  uint32_t m_seed; ///< seed of the success model
+};
+
+} //namespace ns3
+
+#endif /* ARF_RATE_CONTROL_REPLAY_H */
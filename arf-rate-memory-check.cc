@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Check of the rate memory (RateMemorySize) of AarfWifiManager combined
+ * with the fast start (FastStart).
+ *
+ * An 802.11a peer associates and climbs a few rates with successful data
+ * frames, which records its rate in the rate memory. The manager is then
+ * Reset, which deletes its stations, and the peer comes back as a returning
+ * peer does: a frame is first received from it, before its capabilities
+ * are known, so that the fast start keeps the SNR of the frame and waits
+ * for the final ladder, then its supported rates are added and a data tx
+ * vector is asked for.
+ *
+ * The FastStartSnrTable maps every SNR to the lowest rate, so the fast
+ * start and the rate memory disagree. The returning peer must resume at
+ * its remembered rate, and a manager without rate memory must start it at
+ * the lowest rate. The program exits with a non-zero status otherwise.
+ *
+ * The program links with the ns-3 core, network and wifi modules:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-rate-memory-check.cc
+ *       -L<ns-3 lib dir> -l<wifi lib> -l<network lib> -l<core lib>
+ *
+ * where the library names depend on the version and build profile of
+ * ns-3, e.g. ns3.28-wifi-optimized for an optimized ns-3.28 build.
+ */
+
+#include <iostream>
+#include "ns3/boolean.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "aarf-wifi-manager.h"
+#include "wifi-mac-header.h"
+#include "yans-wifi-phy.h"
+
+using namespace ns3;
+
+namespace {
+
+const double SNR = 1000; ///< SNR of every frame of the peer (30 dB)
+const uint32_t MIN_CHANGES = 3; ///< rate increases before the peer leaves
+
+/**
+ * \brief rates of the peer before and after its return
+ */
+struct Outcome
+{
+  WifiMode m_left; ///< rate of the peer when it left
+  WifiMode m_returned; ///< rate of the peer when it came back
+};
+
+/**
+ * Let a peer climb, leave and come back.
+ *
+ * \param rateMemorySize the RateMemorySize attribute
+ * \return the rates of the peer
+ */
+Outcome
+Run (uint32_t rateMemorySize)
+{
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<AarfWifiManager> manager = CreateObject<AarfWifiManager> ();
+  manager->SetAttribute ("FastStart", BooleanValue (true));
+  manager->SetAttribute ("FastStartSnrTable", StringValue ("0:0"));
+  manager->SetAttribute ("RateMemorySize", UintegerValue (rateMemorySize));
+  manager->SetupPhy (phy);
+
+  Mac48Address peer = Mac48Address::Allocate ();
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_DATA);
+  header.SetAddr1 (peer);
+  Ptr<Packet> packet = Create<Packet> (1000);
+
+  manager->AddAllSupportedModes (peer);
+  manager->RecordGotAssocTxOk (peer);
+  //climb until the last success was at the current rate, so that it is remembered
+  WifiMode mode = manager->GetDataTxVector (peer, &header, packet).GetMode ();
+  uint32_t changes = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      manager->ReportDataOk (peer, &header, SNR, mode, SNR);
+      WifiMode next = manager->GetDataTxVector (peer, &header, packet).GetMode ();
+      if (next == mode && changes >= MIN_CHANGES)
+        {
+          break;
+        }
+      changes += (next != mode);
+      mode = next;
+    }
+
+  Outcome outcome;
+  outcome.m_left = mode;
+  manager->Reset ();
+  manager->ReportRxOk (peer, &header, SNR, phy->GetMode (0));
+  manager->AddAllSupportedModes (peer);
+  manager->RecordGotAssocTxOk (peer);
+  outcome.m_returned = manager->GetDataTxVector (peer, &header, packet).GetMode ();
+  manager->Dispose ();
+  phy->Dispose ();
+  return outcome;
+}
+
+} //anonymous namespace
+
+int
+main (void)
+{
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  WifiMode lowest = phy->GetMode (0);
+  phy->Dispose ();
+
+  bool ok = true;
+  Outcome remembered = Run (16);
+  std::cout << "rate memory: left at " << remembered.m_left
+            << ", returned at " << remembered.m_returned << std::endl;
+  if (remembered.m_left == lowest || remembered.m_returned != remembered.m_left)
+    {
+      std::cout << "FAIL: the returning peer did not resume at its remembered rate" << std::endl;
+      ok = false;
+    }
+  Outcome forgotten = Run (0);
+  std::cout << "no rate memory: left at " << forgotten.m_left
+            << ", returned at " << forgotten.m_returned << std::endl;
+  if (forgotten.m_returned != lowest)
+    {
+      std::cout << "FAIL: the fast start did not seed the returning peer" << std::endl;
+      ok = false;
+    }
+  return ok ? 0 : 1;
+}
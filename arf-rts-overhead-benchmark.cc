@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the RTS/CTS protection overhead of ArfWifiManager with and
+ * without RTS rate adaptation (RtsRateAdaptation).
+ *
+ * An 802.11a manager with a BasicRateSet of 6, 12 and 24 Mb/s protects
+ * every data frame of its peers with RTS/CTS. The SNRs of the peers are
+ * spread evenly over [snrMin, snrMax] dB. Without adaptation every RTS is
+ * sent at 6 Mb/s, the lowest supported rate. With adaptation the RTS rate
+ * of each peer is driven by the controller the manager uses for RTS
+ * frames: the ARF engine on a compact state over the basic rates, with
+ * the default RtsSuccessThreshold (10) and RtsTimerThreshold (15), fed
+ * what ReportRtsOk and ReportRtsFailed feed it.
+ *
+ * An RTS gets through with the chunk success rate of the NIST error rate
+ * model at the SNR of the peer, and a failed RTS is sent again, up to the
+ * default short retry count. The CTS is sent at the rate of the RTS, the
+ * highest basic rate not faster than it, and always gets through. Frame
+ * durations are those of the 802.11a OFDM PHY. The NIST chunk success
+ * rate and the durations are computed here as NistErrorRateModel and
+ * WifiPhy compute them for these three rates, so that the benchmark only
+ * needs the ns-3 headers:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-rts-overhead-benchmark.cc
+ *
+ * For each SNR range and setting the program reports the RTS and CTS
+ * airtime per protected frame, failed attempts included, the fraction of
+ * the RTS that fail and the mean RTS rate. The number of peers and of
+ * frames per peer can be given as first and second argument.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "arf-family-wifi-manager.h"
+
+using namespace ns3;
+
+namespace {
+
+const uint32_t RTS_SIZE = 20; ///< size of an RTS frame, FCS included (bytes)
+const uint32_t CTS_SIZE = 14; ///< size of a CTS frame, FCS included (bytes)
+const uint32_t MAX_RTS_ATTEMPTS = 7; ///< attempts per RTS, the default MaxSsrc
+const uint32_t N_BASIC = 3; ///< number of basic rates
+const double BASIC_RATES[N_BASIC] = {6, 12, 24}; ///< basic rates (Mb/s)
+
+/**
+ * \brief protection overhead of one run
+ */
+struct Overhead
+{
+  double m_airtimeUs; ///< RTS and CTS airtime per protected frame (us)
+  double m_failureRatio; ///< fraction of the RTS that failed
+  double m_meanRtsRate; ///< mean data rate of the RTS (Mb/s)
+};
+
+/**
+ * \param bytes the frame size, FCS included
+ * \param rate the index of the basic rate
+ * \return the duration of the frame (us): preamble and SIGNAL field, then
+ *         4 us symbols holding the SERVICE field, the frame and the tail
+ */
+double
+GetDuration (uint32_t bytes, uint32_t rate)
+{
+  double bitsPerSymbol = BASIC_RATES[rate] * 4;
+  return 20 + 4 * std::ceil ((16 + 8.0 * bytes + 6) / bitsPerSymbol);
+}
+
+/**
+ * \param snr the SNR (linear)
+ * \param rate the index of the basic rate
+ * \param nbits the size of the chunk (bits)
+ * \return the chunk success rate of the NIST error rate model for the
+ *         rate 1/2 BPSK, QPSK and 16-QAM modes
+ */
+double
+GetChunkSuccessRate (double snr, uint32_t rate, uint32_t nbits)
+{
+  double ber;
+  if (rate == 0)
+    {
+      ber = 0.5 * std::erfc (std::sqrt (snr));
+    }
+  else if (rate == 1)
+    {
+      ber = 0.5 * std::erfc (std::sqrt (snr / 2.0));
+    }
+  else
+    {
+      ber = 0.75 * 0.5 * std::erfc (std::sqrt (snr / (5.0 * 2.0)));
+    }
+  if (ber == 0.0)
+    {
+      return 1.0;
+    }
+  //first event error probability of the rate 1/2 convolutional code
+  double d = std::sqrt (4.0 * ber * (1.0 - ber));
+  double pe = 0.5 * (36.0 * std::pow (d, 10)
+                     + 211.0 * std::pow (d, 12)
+                     + 1404.0 * std::pow (d, 14)
+                     + 11633.0 * std::pow (d, 16)
+                     + 77433.0 * std::pow (d, 18)
+                     + 502690.0 * std::pow (d, 20)
+                     + 3322763.0 * std::pow (d, 22)
+                     + 21292910.0 * std::pow (d, 24)
+                     + 134365911.0 * std::pow (d, 26));
+  pe = std::min (pe, 1.0);
+  return std::pow (1 - pe, nbits);
+}
+
+/**
+ * Protect frames for all the peers of a manager.
+ *
+ * \param adapt whether RTS rate adaptation is enabled
+ * \param snrMin the SNR of the worst peer (dB)
+ * \param snrMax the SNR of the best peer (dB)
+ * \param nStations the number of peers
+ * \param frames the number of protected frames per peer
+ * \return the protection overhead
+ */
+Overhead
+Run (bool adapt, double snrMin, double snrMax, uint32_t nStations, uint32_t frames)
+{
+  ArfFamilyRateControl<ArfThresholdPolicy> rtsRateControl;
+  rtsRateControl.m_successThreshold = 10;
+  rtsRateControl.m_timerThreshold = 15;
+
+  std::vector<ArfFamilyCompactState> states (nStations);
+  std::vector<double> snrs;
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      rtsRateControl.InitState (states[i]);
+      double snrDb = (nStations > 1) ? snrMin + (snrMax - snrMin) * i / (nStations - 1) : snrMin;
+      snrs.push_back (std::pow (10.0, snrDb / 10.0));
+    }
+
+  std::mt19937 rng (1);
+  std::uniform_real_distribution<double> uniform (0, 1);
+  double airtime = 0;
+  double rateSum = 0;
+  uint64_t nRts = 0;
+  uint64_t nFailed = 0;
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      for (uint32_t i = 0; i < nStations; i++)
+        {
+          for (uint32_t attempt = 0; attempt < MAX_RTS_ATTEMPTS; attempt++)
+            {
+              uint32_t rate = adapt ? std::min (states[i].GetRate (), N_BASIC - 1) : 0;
+              airtime += GetDuration (RTS_SIZE, rate);
+              rateSum += BASIC_RATES[rate];
+              nRts++;
+              if (uniform (rng) >= GetChunkSuccessRate (snrs[i], rate, RTS_SIZE * 8))
+                {
+                  nFailed++;
+                  if (adapt)
+                    {
+                      rtsRateControl.UpdateOnDataFailed (states[i]);
+                    }
+                  continue;
+                }
+              airtime += GetDuration (CTS_SIZE, rate);
+              if (adapt)
+                {
+                  rtsRateControl.UpdateOnDataOk (states[i], N_BASIC);
+                }
+              break;
+            }
+        }
+    }
+
+  Overhead overhead;
+  overhead.m_airtimeUs = airtime / (static_cast<double> (frames) * nStations);
+  overhead.m_failureRatio = static_cast<double> (nFailed) / nRts;
+  overhead.m_meanRtsRate = rateSum / nRts;
+  return overhead;
+}
+
+} //anonymous namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nStations = 50;
+  uint32_t frames = 2000;
+  if (argc > 1)
+    {
+      nStations = std::atoi (argv[1]);
+    }
+  if (argc > 2)
+    {
+      frames = std::atoi (argv[2]);
+    }
+
+  const double ranges[][2] = {{3, 8}, {5, 15}, {10, 25}, {20, 35}};
+  std::cout << std::setw (12) << "snr (dB)"
+            << std::setw (16) << "lowest us/frame"
+            << std::setw (15) << "adapted"
+            << std::setw (10) << "saved"
+            << std::setw (14) << "lowest fail"
+            << std::setw (14) << "adapted fail"
+            << std::setw (14) << "adapted Mb/s" << std::endl;
+  for (uint32_t r = 0; r < sizeof (ranges) / sizeof (ranges[0]); r++)
+    {
+      Overhead lowest = Run (false, ranges[r][0], ranges[r][1], nStations, frames);
+      Overhead adapted = Run (true, ranges[r][0], ranges[r][1], nStations, frames);
+      std::cout << std::fixed << std::setprecision (1)
+                << std::setw (5) << ranges[r][0] << " - " << std::setw (4) << ranges[r][1]
+                << std::setw (16) << lowest.m_airtimeUs
+                << std::setw (15) << adapted.m_airtimeUs
+                << std::setw (9) << 100 * (1 - adapted.m_airtimeUs / lowest.m_airtimeUs) << "%"
+                << std::setprecision (4)
+                << std::setw (14) << lowest.m_failureRatio
+                << std::setw (14) << adapted.m_failureRatio
+                << std::setprecision (1)
+                << std::setw (14) << adapted.m_meanRtsRate << std::endl;
+    }
+  return 0;
+}
@@ -0,0 +1,377 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the ARF family station pool (ArfFamilyStationPool) against
+ * the global operator new under association churn.
+ *
+ * Stations are stand-ins of the size of the manager stations (96 bytes
+ * with ArfFamilyCompactState, 120 with ArfFamilyState, a virtual
+ * destructor and the state at the same place), allocated either with the
+ * global operator new or from a pool. Each association also allocates
+ * what the base class allocates for a new peer, a station state and its
+ * vector of supported modes, with the global operator new in both cases,
+ * so that the stations compete with other allocations as in a simulation.
+ *
+ * For each station count (10k and 100k by default) the program reports:
+ * - "hot fresh": ns per outcome reported to the engine over all the
+ *   stations in turn, right after they were created;
+ * - "churn": ns per disassociation and association of a random station,
+ *   over ten times the station count;
+ * - "hot churned": ns per outcome as in "hot fresh", after the churn.
+ *
+ * The four configurations take turns five times and the fastest time of
+ * each phase is reported.
+ *
+ * The largest station count can be given as first argument. The engine
+ * and the pool are header-only, so the benchmark only needs the ns-3
+ * headers:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-station-churn-benchmark.cc
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "arf-family-station-pool.h"
+#include "arf-family-wifi-manager.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief stand-in of an ARF family manager station
+ */
+template <class State, size_t Size>
+struct HeapStation
+{
+  virtual ~HeapStation ()
+  {
+  }
+  State m_arf; ///< state of the ARF state machine
+  char m_rest[Size - sizeof (void *) - sizeof (State)]; ///< rest of the station
+};
+
+/**
+ * \brief stand-in of an ARF family manager station allocated from a pool
+ */
+template <class State, size_t Size>
+struct PoolStation : public HeapStation<State, Size>
+{
+  /**
+   * \param size the size of the object
+   * \param pool the pool to allocate from
+   * \return storage for the station
+   */
+  static void * operator new (size_t size, ArfFamilyStationPool *pool)
+  {
+    return pool->Allocate (size);
+  }
+  /**
+   * \param p the storage of the station
+   */
+  static void operator delete (void *p)
+  {
+    ArfFamilyStationPool::Deallocate (p);
+  }
+  /**
+   * \param p the storage of the station
+   * \param pool the pool the storage came from
+   */
+  static void operator delete (void *p, ArfFamilyStationPool *pool)
+  {
+    NS_UNUSED (pool);
+    ArfFamilyStationPool::Deallocate (p);
+  }
+};
+
+/**
+ * \brief what the base class allocates for a new peer besides the station
+ */
+struct PeerState
+{
+  char m_state[160]; ///< stand-in of WifiRemoteStationState
+  std::vector<uint32_t> m_modes; ///< stand-in of the supported modes
+};
+
+/**
+ * \brief global operator new allocation
+ */
+template <class State, size_t Size>
+struct HeapAllocator
+{
+  typedef HeapStation<State, Size> Station; ///< station type
+
+  HeapAllocator ()
+  {
+  }
+  /// \return a new station
+  Station * Create (void)
+  {
+    return new Station ();
+  }
+  /// \return a name for the report
+  static std::string GetName (void)
+  {
+    return "heap";
+  }
+};
+
+/**
+ * \brief pool allocation
+ */
+template <class State, size_t Size>
+struct PoolAllocator
+{
+  typedef PoolStation<State, Size> Station; ///< station type
+
+  PoolAllocator ()
+    : m_pool (new ArfFamilyStationPool (sizeof (Station), alignof (Station)))
+  {
+  }
+  ~PoolAllocator ()
+  {
+    m_pool->Release ();
+  }
+  /// \return a new station
+  Station * Create (void)
+  {
+    return new (m_pool) Station ();
+  }
+  /// \return a name for the report
+  static std::string GetName (void)
+  {
+    return "pool";
+  }
+
+  ArfFamilyStationPool *m_pool; ///< the pool
+};
+
+/**
+ * Report one outcome per station, in turn, for several rounds.
+ *
+ * \param control the engine
+ * \param stations the stations
+ * \param outcomes the outcomes to report, cycled through
+ * \param rounds the number of rounds
+ * \param checksum the sum of the rates, so that the loop is not optimized out
+ * \return ns per outcome
+ */
+template <class Station>
+double
+HotPath (const ArfFamilyRateControl<AarfThresholdPolicy> &control, std::vector<Station *> &stations,
+         const std::vector<bool> &outcomes, uint32_t rounds, uint64_t &checksum)
+{
+  uint64_t k = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (typename std::vector<Station *>::iterator i = stations.begin (); i != stations.end (); i++)
+        {
+          if (outcomes[k++ % outcomes.size ()])
+            {
+              control.UpdateOnDataOk ((*i)->m_arf, 8);
+            }
+          else
+            {
+              control.UpdateOnDataFailed ((*i)->m_arf);
+            }
+          checksum += (*i)->m_arf.GetRate ();
+        }
+    }
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  return seconds * 1e9 / (static_cast<double> (rounds) * stations.size ());
+}
+
+/**
+ * \brief times of the three phases of one run, in ns per operation
+ */
+struct Timings
+{
+  double m_fresh; ///< hot path right after the stations were created
+  double m_churn; ///< disassociation and association of a random station
+  double m_churned; ///< hot path after the churn
+
+  /**
+   * Keep the fastest time of each phase.
+   *
+   * \param other the times of another run of the same configuration
+   */
+  void KeepBest (const Timings &other)
+  {
+    m_fresh = std::min (m_fresh, other.m_fresh);
+    m_churn = std::min (m_churn, other.m_churn);
+    m_churned = std::min (m_churned, other.m_churned);
+  }
+};
+
+/**
+ * Run the three phases for one allocator and station count.
+ *
+ * \param control the engine
+ * \param nStations the number of stations
+ * \param churnFactor the number of churn operations per station
+ * \param rounds the number of rounds of the hot path phases
+ * \param checksum the sum of the rates, so that the hot path is not optimized out
+ * \return the times of the phases
+ */
+template <class Allocator, class State>
+Timings
+Run (const ArfFamilyRateControl<AarfThresholdPolicy> &control, uint32_t nStations, uint32_t churnFactor,
+     uint32_t rounds, uint64_t &checksum)
+{
+  typedef typename Allocator::Station Station;
+  Allocator allocator;
+  std::mt19937 rng (1);
+  std::vector<bool> outcomes;
+  std::uniform_real_distribution<double> uniform (0, 1);
+  for (uint32_t i = 0; i < 4093; i++)
+    {
+      outcomes.push_back (uniform (rng) >= 0.1);
+    }
+
+  std::vector<Station *> stations;
+  std::vector<PeerState *> peers;
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      peers.push_back (new PeerState ());
+      peers.back ()->m_modes.resize (8 + i % 5);
+      stations.push_back (allocator.Create ());
+      control.InitState (stations.back ()->m_arf);
+    }
+  Timings timings;
+  timings.m_fresh = HotPath (control, stations, outcomes, rounds, checksum);
+
+  uint64_t nChurn = static_cast<uint64_t> (churnFactor) * nStations;
+  std::uniform_int_distribution<uint32_t> pick (0, nStations - 1);
+  std::vector<uint32_t> victims (nChurn);
+  for (uint64_t i = 0; i < nChurn; i++)
+    {
+      victims[i] = pick (rng);
+    }
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint64_t i = 0; i < nChurn; i++)
+    {
+      uint32_t v = victims[i];
+      delete stations[v];
+      delete peers[v];
+      peers[v] = new PeerState ();
+      peers[v]->m_modes.resize (8 + i % 5);
+      stations[v] = allocator.Create ();
+      control.InitState (stations[v]->m_arf);
+    }
+  timings.m_churn = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count () * 1e9 / nChurn;
+
+  timings.m_churned = HotPath (control, stations, outcomes, rounds, checksum);
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      delete stations[i];
+      delete peers[i];
+    }
+
+  return timings;
+}
+
+/**
+ * Print one line of the report.
+ *
+ * \param name the name of the state and allocator
+ * \param nStations the number of stations
+ * \param size the size of a station
+ * \param timings the times of the phases
+ */
+void
+Print (const std::string &name, uint32_t nStations, size_t size, const Timings &timings)
+{
+  std::cout << std::left << std::setw (16) << name
+            << std::right << std::setw (9) << nStations
+            << std::setw (7) << size
+            << std::fixed << std::setprecision (2)
+            << std::setw (11) << timings.m_fresh
+            << std::setw (11) << timings.m_churn
+            << std::setw (13) << timings.m_churned << std::endl;
+}
+
+} //anonymous namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t minStations = 10000;
+  uint32_t maxStations = 100000;
+  uint32_t churnFactor = 10;
+  uint32_t rounds = 20;
+  uint32_t repetitions = 5;
+  if (argc > 1)
+    {
+      maxStations = std::stoul (argv[1]);
+      minStations = std::min (minStations, maxStations);
+    }
+
+  ArfFamilyRateControl<AarfThresholdPolicy> aarf;
+  aarf.m_minTimerThreshold = 15;
+  aarf.m_minSuccessThreshold = 10;
+  aarf.m_successK = 2;
+  aarf.m_timerK = 2;
+  aarf.m_maxSuccessThreshold = 60;
+
+  typedef HeapAllocator<ArfFamilyCompactState, 96> CompactHeap;
+  typedef PoolAllocator<ArfFamilyCompactState, 96> CompactPool;
+  typedef HeapAllocator<ArfFamilyState, 120> FullHeap;
+  typedef PoolAllocator<ArfFamilyState, 120> FullPool;
+  std::cout << std::left << std::setw (16) << "state/alloc"
+            << std::right << std::setw (9) << "stations"
+            << std::setw (7) << "B/sta"
+            << std::setw (11) << "hot fresh"
+            << std::setw (11) << "churn"
+            << std::setw (13) << "hot churned" << std::endl;
+  uint64_t checksum = 0;
+  for (uint32_t n = minStations; n <= maxStations; n *= 10)
+    {
+      //the configurations take turns and the fastest time of each phase is
+      //kept, which filters out most of the noise of a shared host
+      Timings best[4];
+      for (uint32_t k = 0; k < repetitions; k++)
+        {
+          Timings timings[4];
+          timings[0] = Run<CompactHeap, ArfFamilyCompactState> (aarf, n, churnFactor, rounds, checksum);
+          timings[1] = Run<CompactPool, ArfFamilyCompactState> (aarf, n, churnFactor, rounds, checksum);
+          timings[2] = Run<FullHeap, ArfFamilyState> (aarf, n, churnFactor, rounds, checksum);
+          timings[3] = Run<FullPool, ArfFamilyState> (aarf, n, churnFactor, rounds, checksum);
+          for (uint32_t c = 0; c < 4; c++)
+            {
+              if (k == 0)
+                {
+                  best[c] = timings[c];
+                }
+              else
+                {
+                  best[c].KeepBest (timings[c]);
+                }
+            }
+        }
+      Print ("compact heap", n, sizeof (CompactHeap::Station), best[0]);
+      Print ("compact pool", n, sizeof (CompactPool::Station), best[1]);
+      Print ("full heap", n, sizeof (FullHeap::Station), best[2]);
+      Print ("full pool", n, sizeof (FullPool::Station), best[3]);
+    }
+  std::cout << "(checksum " << checksum << ")" << std::endl;
+  return 0;
+}
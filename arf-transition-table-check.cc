@@ -0,0 +1,515 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Standalone check of the ARF/AARF state machine engine
+ * (ArfFamilyRateControl) against the code of the former ArfWifiManager
+ * and AarfWifiManager, plus a microbenchmark of both.
+ *
+ * Every outcome of an ACK/failure sequence is fed to the engine and to a
+ * copy of the former ArfWifiManager/AarfWifiManager DoReportDataOk and
+ * DoReportDataFailed code, and the states are compared after each
+ * outcome: the whole state for ArfFamilyState, and the rate trajectory,
+ * recovery flag and thresholds for ArfFamilyCompactState, whose counters
+ * saturate. Sequences are read from the file given as first argument,
+ * one outcome per character, '1' for an ACK and '0' for a failure, other
+ * characters being ignored; without argument, Gilbert-Elliott sequences
+ * with fixed seeds are used.
+ *
+ * The engine is header-only, so the check only needs the ns-3 headers:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-transition-table-check.cc
+ *
+ * The benchmark replays the first sequence on the former ARF and AARF
+ * code ("arf branches", "aarf branches") and on the engine with each
+ * state representation ("arf engine", "arf engine compact", ...).
+ *
+ * The program exits with a non-zero status if any state differs.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "arf-family-wifi-manager.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Station state and transitions of the ARF and AARF managers, as they
+ * were before the shared engine.
+ */
+struct ReferenceStation
+{
+  uint32_t m_timer; ///< timer value
+  uint32_t m_success; ///< success count
+  uint32_t m_failed; ///< failed count
+  bool m_recovery; ///< recovery
+  uint32_t m_retry; ///< retry count
+  uint32_t m_timerTimeout; ///< timer timeout
+  uint32_t m_successThreshold; ///< success threshold
+  uint32_t m_rate; ///< rate
+};
+
+/**
+ * \brief branch-based reference of one ARF family variant
+ */
+template <class Policy>
+struct Reference;
+
+/**
+ * ARF compared the station counters against the manager thresholds.
+ */
+template <>
+struct Reference<ArfThresholdPolicy>
+{
+  static void Init (ReferenceStation &st, const ArfThresholdPolicy &p)
+  {
+    st = ReferenceStation ();
+    st.m_timerTimeout = p.m_timerThreshold;
+    st.m_successThreshold = p.m_successThreshold;
+  }
+  static void DataFailed (ReferenceStation &st, const ArfThresholdPolicy &p)
+  {
+    NS_UNUSED (p);
+    st.m_timer++;
+    st.m_failed++;
+    st.m_retry++;
+    st.m_success = 0;
+    if (st.m_recovery)
+      {
+        if (st.m_retry == 1)
+          {
+            if (st.m_rate != 0)
+              {
+                st.m_rate--;
+              }
+          }
+        st.m_timer = 0;
+      }
+    else
+      {
+        if (((st.m_retry - 1) % 2) == 1)
+          {
+            if (st.m_rate != 0)
+              {
+                st.m_rate--;
+              }
+          }
+        if (st.m_retry >= 2)
+          {
+            st.m_timer = 0;
+          }
+      }
+  }
+  static void DataOk (ReferenceStation &st, const ArfThresholdPolicy &p, uint32_t nRates)
+  {
+    st.m_timer++;
+    st.m_success++;
+    st.m_failed = 0;
+    st.m_recovery = false;
+    st.m_retry = 0;
+    if ((st.m_success == p.m_successThreshold
+         || st.m_timer == p.m_timerThreshold)
+        && (st.m_rate < (nRates - 1)))
+      {
+        st.m_rate++;
+        st.m_timer = 0;
+        st.m_success = 0;
+        st.m_recovery = true;
+      }
+  }
+};
+
+/**
+ * AARF adapted the station thresholds on fallbacks.
+ */
+template <>
+struct Reference<AarfThresholdPolicy>
+{
+  static void Init (ReferenceStation &st, const AarfThresholdPolicy &p)
+  {
+    st = ReferenceStation ();
+    st.m_timerTimeout = p.m_minTimerThreshold;
+    st.m_successThreshold = p.m_minSuccessThreshold;
+  }
+  static void DataFailed (ReferenceStation &st, const AarfThresholdPolicy &p)
+  {
+    st.m_timer++;
+    st.m_failed++;
+    st.m_retry++;
+    st.m_success = 0;
+    if (st.m_recovery)
+      {
+        if (st.m_retry == 1)
+          {
+            st.m_successThreshold = (int)(std::min (st.m_successThreshold * p.m_successK,
+                                                    (double) p.m_maxSuccessThreshold));
+            st.m_timerTimeout = (int)(std::max (st.m_timerTimeout * p.m_timerK,
+                                                (double) p.m_minSuccessThreshold));
+            if (st.m_rate != 0)
+              {
+                st.m_rate--;
+              }
+          }
+        st.m_timer = 0;
+      }
+    else
+      {
+        if (((st.m_retry - 1) % 2) == 1)
+          {
+            st.m_timerTimeout = p.m_minTimerThreshold;
+            st.m_successThreshold = p.m_minSuccessThreshold;
+            if (st.m_rate != 0)
+              {
+                st.m_rate--;
+              }
+          }
+        if (st.m_retry >= 2)
+          {
+            st.m_timer = 0;
+          }
+      }
+  }
+  static void DataOk (ReferenceStation &st, const AarfThresholdPolicy &p, uint32_t nRates)
+  {
+    NS_UNUSED (p);
+    st.m_timer++;
+    st.m_success++;
+    st.m_failed = 0;
+    st.m_recovery = false;
+    st.m_retry = 0;
+    if ((st.m_success == st.m_successThreshold
+         || st.m_timer == st.m_timerTimeout)
+        && (st.m_rate < (nRates - 1)))
+      {
+        st.m_rate++;
+        st.m_timer = 0;
+        st.m_success = 0;
+        st.m_recovery = true;
+      }
+  }
+};
+
+/**
+ * \param state the engine state
+ * \param ref the reference state
+ * \param full whether the counters must match too
+ * \return true if the states match
+ */
+template <class State>
+bool
+IsSame (const State &state, const ReferenceStation &ref, bool full)
+{
+  bool same = state.GetRate () == ref.m_rate
+    && state.GetRecovery () == ref.m_recovery
+    && state.GetSuccessThreshold () == ref.m_successThreshold
+    && state.GetTimerTimeout () == ref.m_timerTimeout;
+  if (full)
+    {
+      same = same && state.GetTimer () == ref.m_timer
+        && state.GetSuccess () == ref.m_success
+        && state.GetRetry () == ref.m_retry;
+    }
+  return same;
+}
+
+/**
+ * Replay a sequence on the engine and on the reference.
+ *
+ * \param name the name of the configuration, for the report
+ * \param control the engine
+ * \param outcomes the sequence, true for an ACK
+ * \param nRates the size of the ladder
+ * \param full whether the counters must match too
+ * \return the number of mismatches, 0 or 1
+ */
+template <class Policy, class State>
+uint32_t
+Check (const std::string &name, const ArfFamilyRateControl<Policy> &control,
+       const std::vector<bool> &outcomes, uint32_t nRates, bool full)
+{
+  State state = State ();
+  control.InitState (state);
+  ReferenceStation ref;
+  Reference<Policy>::Init (ref, control);
+  for (uint32_t i = 0; i < outcomes.size (); i++)
+    {
+      if (outcomes[i])
+        {
+          control.UpdateOnDataOk (state, nRates);
+          Reference<Policy>::DataOk (ref, control, nRates);
+        }
+      else
+        {
+          control.UpdateOnDataFailed (state);
+          Reference<Policy>::DataFailed (ref, control);
+        }
+      if (!IsSame (state, ref, full))
+        {
+          std::cout << name << " nRates=" << nRates << ": mismatch at outcome " << i
+                    << ", rate " << state.GetRate () << " instead of " << ref.m_rate << std::endl;
+          return 1;
+        }
+    }
+  return 0;
+}
+
+/**
+ * \param outcomes the sequence, true for an ACK
+ * \param seed the seed of the sequence
+ * \param length the number of outcomes
+ */
+void
+MakeGilbertElliott (std::vector<bool> &outcomes, uint32_t seed, uint32_t length)
+{
+  std::mt19937 rng (seed);
+  std::uniform_real_distribution<double> uniform (0, 1);
+  bool bad = false;
+  outcomes.clear ();
+  for (uint32_t i = 0; i < length; i++)
+    {
+      bad = bad ? (uniform (rng) >= 0.1) : (uniform (rng) < 0.02);
+      outcomes.push_back (uniform (rng) >= (bad ? 0.7 : 0.05));
+    }
+}
+
+/**
+ * \param filename the file to read
+ * \param outcomes the sequence read, true for an ACK
+ * \return true if the file could be read
+ */
+bool
+Load (const char *filename, std::vector<bool> &outcomes)
+{
+  std::ifstream is (filename);
+  if (!is)
+    {
+      return false;
+    }
+  char c;
+  while (is.get (c))
+    {
+      if (c == '0' || c == '1')
+        {
+          outcomes.push_back (c == '1');
+        }
+    }
+  return true;
+}
+
+/**
+ * \brief one outcome applied to the former code of one variant
+ */
+template <class Policy>
+struct BranchesStep
+{
+  ReferenceStation m_station; ///< the station
+  const Policy *m_policy; ///< the thresholds
+  uint32_t m_nRates; ///< the size of the ladder
+
+  /**
+   * \param ok whether the transmission succeeded
+   * \return the new rate
+   */
+  uint32_t operator() (bool ok)
+  {
+    if (ok)
+      {
+        Reference<Policy>::DataOk (m_station, *m_policy, m_nRates);
+      }
+    else
+      {
+        Reference<Policy>::DataFailed (m_station, *m_policy);
+      }
+    return m_station.m_rate;
+  }
+};
+
+/**
+ * \brief one outcome applied to the engine
+ */
+template <class Policy, class State>
+struct EngineStep
+{
+  State m_state; ///< the station state
+  const ArfFamilyRateControl<Policy> *m_control; ///< the engine
+  uint32_t m_nRates; ///< the size of the ladder
+
+  /**
+   * \param ok whether the transmission succeeded
+   * \return the new rate
+   */
+  uint32_t operator() (bool ok)
+  {
+    if (ok)
+      {
+        m_control->UpdateOnDataOk (m_state, m_nRates);
+      }
+    else
+      {
+        m_control->UpdateOnDataFailed (m_state);
+      }
+    return m_state.GetRate ();
+  }
+};
+
+/**
+ * \brief the three implementations of one variant, timed side by side
+ */
+template <class Policy>
+struct Contenders
+{
+  BranchesStep<Policy> m_branches; ///< the former code
+  EngineStep<Policy, ArfFamilyState> m_engine; ///< the engine
+  EngineStep<Policy, ArfFamilyCompactState> m_engineCompact; ///< the engine with the compact state
+
+  /**
+   * \param control the engine
+   * \param nRates the size of the ladder
+   */
+  Contenders (const ArfFamilyRateControl<Policy> &control, uint32_t nRates)
+  {
+    Reference<Policy>::Init (m_branches.m_station, control);
+    m_branches.m_policy = &control;
+    m_branches.m_nRates = nRates;
+    m_engine.m_state = ArfFamilyState ();
+    control.InitState (m_engine.m_state);
+    m_engine.m_control = &control;
+    m_engine.m_nRates = nRates;
+    m_engineCompact.m_state = ArfFamilyCompactState ();
+    control.InitState (m_engineCompact.m_state);
+    m_engineCompact.m_control = &control;
+    m_engineCompact.m_nRates = nRates;
+  }
+};
+
+/**
+ * Time the transitions of a sequence on one implementation.
+ *
+ * \param outcomes the sequence, true for an ACK
+ * \param rounds the number of times the sequence is replayed
+ * \param step the functor applying one outcome, returning the new rate
+ * \param checksum the sum of the rates, so that the replay is not optimized out
+ * \return the time taken, in seconds
+ */
+template <class Step>
+double
+TimeReplay (const std::vector<uint8_t> &outcomes, uint32_t rounds, Step &step, uint64_t &checksum)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < outcomes.size (); i++)
+        {
+          checksum += step (outcomes[i] != 0);
+        }
+    }
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
+} //anonymous namespace
+
+int
+main (int argc, char *argv[])
+{
+  ArfFamilyRateControl<ArfThresholdPolicy> arf;
+  arf.m_timerThreshold = 15;
+  arf.m_successThreshold = 10;
+  ArfFamilyRateControl<AarfThresholdPolicy> aarf;
+  aarf.m_minTimerThreshold = 15;
+  aarf.m_minSuccessThreshold = 10;
+  aarf.m_successK = 2;
+  aarf.m_timerK = 2;
+  aarf.m_maxSuccessThreshold = 60;
+
+  std::vector<std::vector<bool> > sequences;
+  if (argc > 1)
+    {
+      sequences.push_back (std::vector<bool> ());
+      if (!Load (argv[1], sequences.back ()))
+        {
+          std::cerr << "cannot read " << argv[1] << std::endl;
+          return 2;
+        }
+    }
+  else
+    {
+      for (uint32_t seed = 1; seed <= 20; seed++)
+        {
+          sequences.push_back (std::vector<bool> ());
+          MakeGilbertElliott (sequences.back (), seed, 100000);
+        }
+    }
+
+  const uint32_t ladders[] = {1, 2, 4, 8, 12, 128};
+  uint32_t failures = 0;
+  uint32_t checks = 0;
+  for (uint32_t s = 0; s < sequences.size (); s++)
+    {
+      for (uint32_t l = 0; l < sizeof (ladders) / sizeof (ladders[0]); l++)
+        {
+          uint32_t n = ladders[l];
+          failures += Check<ArfThresholdPolicy, ArfFamilyState> ("arf", arf, sequences[s], n, true);
+          failures += Check<AarfThresholdPolicy, ArfFamilyState> ("aarf", aarf, sequences[s], n, true);
+          failures += Check<ArfThresholdPolicy, ArfFamilyCompactState> ("arf compact", arf, sequences[s], n, false);
+          failures += Check<AarfThresholdPolicy, ArfFamilyCompactState> ("aarf compact", aarf, sequences[s], n, false);
+          checks += 4;
+        }
+    }
+  std::cout << checks - failures << "/" << checks << " trajectories identical" << std::endl;
+
+  const std::vector<uint8_t> outcomes (sequences[0].begin (), sequences[0].end ());
+  const uint32_t nRates = 8;
+  Contenders<ArfThresholdPolicy> arfSteps (arf, nRates);
+  Contenders<AarfThresholdPolicy> aarfSteps (aarf, nRates);
+
+  //the implementations take turns and the fastest replay of each is kept,
+  //which filters out most of the noise of a shared host
+  const uint32_t repetitions = 15;
+  const uint32_t rounds = 20;
+  const char *names[] = {"arf branches", "arf engine", "arf engine compact",
+                         "aarf branches", "aarf engine", "aarf engine compact"};
+  double best[6];
+  uint64_t checksum = 0;
+  for (uint32_t k = 0; k < repetitions; k++)
+    {
+      double seconds[6];
+      seconds[0] = TimeReplay (outcomes, rounds, arfSteps.m_branches, checksum);
+      seconds[1] = TimeReplay (outcomes, rounds, arfSteps.m_engine, checksum);
+      seconds[2] = TimeReplay (outcomes, rounds, arfSteps.m_engineCompact, checksum);
+      seconds[3] = TimeReplay (outcomes, rounds, aarfSteps.m_branches, checksum);
+      seconds[4] = TimeReplay (outcomes, rounds, aarfSteps.m_engine, checksum);
+      seconds[5] = TimeReplay (outcomes, rounds, aarfSteps.m_engineCompact, checksum);
+      for (uint32_t b = 0; b < 6; b++)
+        {
+          best[b] = (k == 0) ? seconds[b] : std::min (best[b], seconds[b]);
+        }
+    }
+  double n = static_cast<double> (rounds) * outcomes.size ();
+  for (uint32_t b = 0; b < 6; b++)
+    {
+      std::cout << names[b] << ": " << n / best[b] / 1e6 << " M transitions/s, "
+                << best[b] * 1e9 / n << " ns/transition" << std::endl;
+    }
+  std::cout << "(checksum " << checksum << ")" << std::endl;
+  return failures != 0;
+}
@@ -0,0 +1,398 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Benchmark of the per-frame data tx vector of ArfWifiManager before and
+ * after the per-station WifiTxVector cache.
+ *
+ * "before" is ReferenceArfWifiManager, a copy of the ArfWifiManager
+ * DoGetDataTxVector, DoReportDataOk and DoReportDataFailed code as it was
+ * before the cache, which rebuilt the vector for every frame. "after" is
+ * ArfWifiManager. Both are 802.11a managers with the same stations and are
+ * driven with the same outcomes: i.i.d. losses whose probability grows
+ * with the rate index, so that the rates keep changing and the cache is
+ * rebuilt as in a real run.
+ *
+ * Each round asks for the data tx vector of every station frames times in
+ * a timed loop, as the MAC does for a frame and its retransmissions, then
+ * reports one outcome per station outside of the timed loop. The time per
+ * GetDataTxVector call includes the station lookup of the base class,
+ * which is reported on its own: it is the time of ReportFinalRtsFailed,
+ * which does nothing in both managers beyond the lookup.
+ *
+ * After each round, the vectors of the two managers are compared, retry
+ * count included. The program exits with a non-zero status if they
+ * differ.
+ *
+ * The program links with the ns-3 core, network and wifi modules:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-tx-vector-benchmark.cc
+ *       -L<ns-3 lib dir> -l<wifi lib> -l<network lib> -l<core lib>
+ *
+ * where the library names depend on the version and build profile of
+ * ns-3, e.g. ns3.28-wifi-optimized for an optimized ns-3.28 build.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "ns3/command-line.h"
+#include "ns3/packet.h"
+#include "ns3/traced-value.h"
+#include "arf-wifi-manager.h"
+#include "wifi-mac-header.h"
+#include "yans-wifi-phy.h"
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \brief station of ReferenceArfWifiManager
+ */
+struct ReferenceArfWifiRemoteStation : public WifiRemoteStation
+{
+  uint32_t m_timer; ///< timer value
+  uint32_t m_success; ///< success count
+  uint32_t m_failed; ///< failed count
+  bool m_recovery; ///< recovery
+  uint32_t m_retry; ///< retry count
+  uint32_t m_timerTimeout; ///< timer timeout
+  uint32_t m_successThreshold; ///< success threshold
+  uint32_t m_rate; ///< rate
+};
+
+/**
+ * \brief ArfWifiManager as it was before the tx vector cache
+ */
+class ReferenceArfWifiManager : public WifiRemoteStationManager
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::ReferenceArfWifiManager")
+      .SetParent<WifiRemoteStationManager> ()
+      .AddConstructor<ReferenceArfWifiManager> ()
+    ;
+    return tid;
+  }
+  ReferenceArfWifiManager ()
+    : m_timerThreshold (15),
+      m_successThreshold (10),
+      m_currentRate (0)
+  {
+  }
+
+private:
+  WifiRemoteStation * DoCreateStation (void) const
+  {
+    ReferenceArfWifiRemoteStation *station = new ReferenceArfWifiRemoteStation ();
+    station->m_successThreshold = m_successThreshold;
+    station->m_timerTimeout = m_timerThreshold;
+    station->m_rate = 0;
+    station->m_success = 0;
+    station->m_failed = 0;
+    station->m_recovery = false;
+    station->m_retry = 0;
+    station->m_timer = 0;
+    return station;
+  }
+  void DoReportRxOk (WifiRemoteStation *station, double rxSnr, WifiMode txMode)
+  {
+  }
+  void DoReportRtsFailed (WifiRemoteStation *station)
+  {
+  }
+  void DoReportDataFailed (WifiRemoteStation *st)
+  {
+    ReferenceArfWifiRemoteStation *station = (ReferenceArfWifiRemoteStation *) st;
+    station->m_timer++;
+    station->m_failed++;
+    station->m_retry++;
+    station->m_success = 0;
+    if (station->m_recovery)
+      {
+        if (station->m_retry == 1)
+          {
+            if (station->m_rate != 0)
+              {
+                station->m_rate--;
+              }
+          }
+        station->m_timer = 0;
+      }
+    else
+      {
+        if (((station->m_retry - 1) % 2) == 1)
+          {
+            if (station->m_rate != 0)
+              {
+                station->m_rate--;
+              }
+          }
+        if (station->m_retry >= 2)
+          {
+            station->m_timer = 0;
+          }
+      }
+  }
+  void DoReportRtsOk (WifiRemoteStation *station, double ctsSnr, WifiMode ctsMode, double rtsSnr)
+  {
+  }
+  void DoReportDataOk (WifiRemoteStation *st, double ackSnr, WifiMode ackMode, double dataSnr)
+  {
+    ReferenceArfWifiRemoteStation *station = (ReferenceArfWifiRemoteStation *) st;
+    station->m_timer++;
+    station->m_success++;
+    station->m_failed = 0;
+    station->m_recovery = false;
+    station->m_retry = 0;
+    if ((station->m_success == m_successThreshold
+         || station->m_timer == m_timerThreshold)
+        && (station->m_rate < (GetNSupported (station) - 1)))
+      {
+        station->m_rate++;
+        station->m_timer = 0;
+        station->m_success = 0;
+        station->m_recovery = true;
+      }
+  }
+  void DoReportFinalRtsFailed (WifiRemoteStation *station)
+  {
+  }
+  void DoReportFinalDataFailed (WifiRemoteStation *station)
+  {
+  }
+  WifiTxVector DoGetDataTxVector (WifiRemoteStation *st)
+  {
+    ReferenceArfWifiRemoteStation *station = (ReferenceArfWifiRemoteStation *) st;
+    uint32_t channelWidth = GetChannelWidth (station);
+    if (channelWidth > 20 && channelWidth != 22)
+      {
+        channelWidth = 20;
+      }
+    WifiMode mode = GetSupported (station, station->m_rate);
+    if (m_currentRate != mode.GetDataRate (channelWidth))
+      {
+        m_currentRate = mode.GetDataRate (channelWidth);
+      }
+    return WifiTxVector (mode, GetDefaultTxPowerLevel (), GetLongRetryCount (station), GetPreambleForTransmission (mode, GetAddress (station)), 800, 1, 1, 0, channelWidth, GetAggregation (station), false);
+  }
+  WifiTxVector DoGetRtsTxVector (WifiRemoteStation *station)
+  {
+    WifiMode mode = GetSupported (station, 0);
+    return WifiTxVector (mode, GetDefaultTxPowerLevel (), GetLongRetryCount (station), GetPreambleForTransmission (mode, GetAddress (station)), 800, 1, 1, 0, 20, GetAggregation (station), false);
+  }
+  bool IsLowLatency (void) const
+  {
+    return true;
+  }
+
+  uint32_t m_timerThreshold; ///< timer threshold
+  uint32_t m_successThreshold; ///< success threshold
+  TracedValue<uint64_t> m_currentRate; ///< rate of the last tx vector
+};
+
+/**
+ * \brief a manager under test and its stations
+ */
+struct Setup
+{
+  Ptr<WifiRemoteStationManager> m_manager; ///< the manager
+  std::vector<Mac48Address> m_stations; ///< addresses of the stations
+  std::mt19937 m_rng; ///< outcome generator, same seed for both managers
+  double m_seconds; ///< time spent in GetDataTxVector
+  double m_lookupSeconds; ///< time spent in ReportFinalRtsFailed
+  uint64_t m_nCalls; ///< number of timed calls
+  uint64_t m_checksum; ///< sum of the mode UIDs returned, so that the calls are not optimized out
+};
+
+/**
+ * \param manager the manager to set up
+ * \param stations the station addresses
+ * \param setup the setup to fill
+ */
+void
+Init (Ptr<WifiRemoteStationManager> manager, const std::vector<Mac48Address> &stations, Setup &setup)
+{
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  manager->SetupPhy (phy);
+  for (std::vector<Mac48Address>::const_iterator i = stations.begin (); i != stations.end (); i++)
+    {
+      manager->AddAllSupportedModes (*i);
+      manager->RecordGotAssocTxOk (*i);
+    }
+  setup.m_manager = manager;
+  setup.m_stations = stations;
+  setup.m_rng.seed (1);
+  setup.m_seconds = 0;
+  setup.m_lookupSeconds = 0;
+  setup.m_nCalls = 0;
+  setup.m_checksum = 0;
+}
+
+/**
+ * Run one round on a manager.
+ *
+ * \param setup the manager
+ * \param header the header of the data frames
+ * \param packet the data packet
+ * \param frames the number of GetDataTxVector calls per station
+ */
+void
+RunRound (Setup &setup, const WifiMacHeader &header, Ptr<const Packet> packet, uint32_t frames)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      for (std::vector<Mac48Address>::const_iterator i = setup.m_stations.begin (); i != setup.m_stations.end (); i++)
+        {
+          setup.m_checksum += setup.m_manager->GetDataTxVector (*i, &header, packet).GetMode ().GetUid ();
+        }
+    }
+  setup.m_seconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  start = std::chrono::steady_clock::now ();
+  for (uint32_t f = 0; f < frames; f++)
+    {
+      for (std::vector<Mac48Address>::const_iterator i = setup.m_stations.begin (); i != setup.m_stations.end (); i++)
+        {
+          setup.m_manager->ReportFinalRtsFailed (*i, &header);
+        }
+    }
+  setup.m_lookupSeconds += std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  setup.m_nCalls += static_cast<uint64_t> (frames) * setup.m_stations.size ();
+
+  std::uniform_real_distribution<double> uniform (0, 1);
+  for (std::vector<Mac48Address>::const_iterator i = setup.m_stations.begin (); i != setup.m_stations.end (); i++)
+    {
+      WifiTxVector txVector = setup.m_manager->GetDataTxVector (*i, &header, packet);
+      double loss = 0.02 + 0.03 * (txVector.GetMode ().GetDataRate (20) / 6000000);
+      if (uniform (setup.m_rng) < loss)
+        {
+          setup.m_manager->ReportDataFailed (*i, &header);
+        }
+      else
+        {
+          setup.m_manager->ReportDataOk (*i, &header, 20, txVector.GetMode (), 20);
+        }
+    }
+}
+
+/**
+ * \param a a tx vector
+ * \param b another tx vector
+ * \return true if the two vectors are the same
+ */
+bool
+IsSame (const WifiTxVector &a, const WifiTxVector &b)
+{
+  return a.GetMode () == b.GetMode ()
+         && a.GetTxPowerLevel () == b.GetTxPowerLevel ()
+         && a.GetRetries () == b.GetRetries ()
+         && a.GetPreambleType () == b.GetPreambleType ()
+         && a.GetChannelWidth () == b.GetChannelWidth ()
+         && a.GetGuardInterval () == b.GetGuardInterval ()
+         && a.GetNss () == b.GetNss ()
+         && a.IsAggregation () == b.IsAggregation ();
+}
+
+/**
+ * \param name the name of the manager
+ * \param setup the manager
+ * \param nStations the number of stations
+ */
+void
+Print (const std::string &name, const Setup &setup, uint32_t nStations)
+{
+  double nsPerCall = setup.m_seconds * 1e9 / setup.m_nCalls;
+  double lookup = setup.m_lookupSeconds * 1e9 / setup.m_nCalls;
+  std::cout << std::left << std::setw (8) << name
+            << std::right << std::setw (10) << nStations
+            << std::fixed << std::setprecision (1)
+            << std::setw (12) << nsPerCall
+            << std::setw (12) << lookup
+            << std::setw (12) << std::max (nsPerCall - lookup, 0.0)
+            << std::endl;
+}
+
+} //anonymous namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t maxStations = 10000;
+  uint32_t rounds = 200;
+  uint32_t frames = 4;
+  CommandLine cmd;
+  cmd.AddValue ("maxStations", "The largest station count, counts go from 1 by powers of 10", maxStations);
+  cmd.AddValue ("rounds", "The number of outcomes reported per station", rounds);
+  cmd.AddValue ("frames", "The number of GetDataTxVector calls per station and round", frames);
+  cmd.Parse (argc, argv);
+
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_DATA);
+  Ptr<Packet> packet = Create<Packet> (1000);
+  uint32_t mismatches = 0;
+  std::cout << std::left << std::setw (8) << "manager"
+            << std::right << std::setw (10) << "stations"
+            << std::setw (12) << "ns/call"
+            << std::setw (12) << "lookup ns"
+            << std::setw (12) << "net ns" << std::endl;
+  for (uint32_t n = 1; n <= maxStations; n *= 10)
+    {
+      std::vector<Mac48Address> stations;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          stations.push_back (Mac48Address::Allocate ());
+        }
+      Setup before;
+      Init (CreateObject<ReferenceArfWifiManager> (), stations, before);
+      Setup after;
+      Init (CreateObject<ArfWifiManager> (), stations, after);
+      for (uint32_t r = 0; r < rounds; r++)
+        {
+          RunRound (before, header, packet, frames);
+          RunRound (after, header, packet, frames);
+          for (uint32_t i = 0; i < n; i++)
+            {
+              if (!IsSame (before.m_manager->GetDataTxVector (stations[i], &header, packet),
+                           after.m_manager->GetDataTxVector (stations[i], &header, packet)))
+                {
+                  if (mismatches++ == 0)
+                    {
+                      std::cout << "tx vectors differ for station " << i << " at round " << r << std::endl;
+                    }
+                }
+            }
+        }
+      Print ("before", before, n);
+      Print ("after", after, n);
+      before.m_manager->Dispose ();
+      after.m_manager->Dispose ();
+    }
+  if (mismatches > 0)
+    {
+      std::cout << mismatches << " tx vector mismatches" << std::endl;
+    }
+  return mismatches != 0;
+}
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Check of the order of the rate ladder with channel width adaptation
+ * (ArfRateLadder::OrderByWidth) on a VHT station with an 80 MHz channel,
+ * one spatial stream and an 800 ns guard interval.
+ *
+ * The ladder gets every allowed (width, MCS) pair of 20, 40 and 80 MHz,
+ * with the data rates of IEEE 802.11ac, in the order BuildLadder creates
+ * them, and is printed once ordered. Walking down from the top, the
+ * widths must never widen again, so that falling back narrows the channel
+ * from 80 to 40 to 20 MHz, the data rates must keep decreasing, and every
+ * pair left out must be matched or beaten by a narrower pair of the
+ * ladder. The program exits with a non-zero status otherwise.
+ *
+ * The ladder is header-only, so the check only needs the ns-3 headers:
+ *
+ *   g++ -std=c++11 -O2 -I<ns-3 include dir> arf-width-ladder-check.cc
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "arf-family-wifi-manager.h"
+
+using namespace ns3;
+
+namespace {
+
+/// data rates (kb/s) of VHT MCS 0 to 9 with one stream and an 800 ns guard interval
+const uint64_t VHT_RATES[3][10] = {
+  {6500, 13000, 19500, 26000, 39000, 52000, 58500, 65000, 78000, 86700}, //20 MHz
+  {13500, 27000, 40500, 54000, 81000, 108000, 121500, 135000, 162000, 180000}, //40 MHz
+  {29250, 58500, 87750, 117000, 175500, 234000, 263250, 292500, 351000, 390000}, //80 MHz
+};
+
+/**
+ * \param width the channel width (MHz)
+ * \param mcs the MCS value
+ * \return whether the pair is allowed with one stream
+ */
+bool
+IsAllowed (uint16_t width, uint32_t mcs)
+{
+  //MCS 9 is not allowed on 20 MHz with one, two or four streams
+  return !(width == 20 && mcs == 9);
+}
+
+} //anonymous namespace
+
+int
+main (void)
+{
+  const uint16_t widths[] = {20, 40, 80};
+  ArfRateLadder ladder;
+  std::vector<ArfRateLadderEntry> all;
+  for (uint32_t w = 0; w < 3; w++)
+    {
+      for (uint32_t mcs = 0; mcs < 10; mcs++)
+        {
+          if (!IsAllowed (widths[w], mcs))
+            {
+              continue;
+            }
+          ArfRateLadderEntry entry;
+          entry.m_mode = WifiMode ();
+          entry.m_nss = 1;
+          entry.m_guardInterval = 800;
+          entry.m_channelWidth = widths[w];
+          entry.m_dataRate = VHT_RATES[w][mcs] * 1000;
+          entry.m_preamble = WIFI_PREAMBLE_LONG;
+          entry.m_snrThreshold = 0;
+          ladder.m_entries.push_back (entry);
+        }
+    }
+  all = ladder.m_entries;
+  ladder.OrderByWidth ();
+
+  bool ok = true;
+  for (uint32_t i = 0; i < ladder.m_entries.size (); i++)
+    {
+      const ArfRateLadderEntry &entry = ladder.m_entries[i];
+      std::cout << std::setw (3) << i << std::setw (5) << entry.m_channelWidth << " MHz"
+                << std::setw (8) << entry.m_dataRate / 1000 << " kb/s" << std::endl;
+      if (i == 0)
+        {
+          continue;
+        }
+      const ArfRateLadderEntry &below = ladder.m_entries[i - 1];
+      if (below.m_channelWidth > entry.m_channelWidth)
+        {
+          std::cout << "FAIL: falling back from rate " << i << " widens the channel" << std::endl;
+          ok = false;
+        }
+      if (below.m_dataRate >= entry.m_dataRate)
+        {
+          std::cout << "FAIL: rate " << i << " is not faster than the rate below it" << std::endl;
+          ok = false;
+        }
+    }
+  if (ladder.m_entries.empty ()
+      || ladder.m_entries.front ().m_channelWidth != 20
+      || ladder.m_entries.back ().m_channelWidth != 80
+      || ladder.m_entries.back ().m_dataRate != all.back ().m_dataRate)
+    {
+      std::cout << "FAIL: the ladder does not span 20 MHz MCS 0 to 80 MHz MCS 9" << std::endl;
+      ok = false;
+    }
+  for (std::vector<ArfRateLadderEntry>::const_iterator i = all.begin (); i != all.end (); i++)
+    {
+      bool kept = false;
+      bool beaten = false;
+      for (std::vector<ArfRateLadderEntry>::const_iterator j = ladder.m_entries.begin (); j != ladder.m_entries.end (); j++)
+        {
+          kept = kept || (j->m_channelWidth == i->m_channelWidth && j->m_dataRate == i->m_dataRate);
+          beaten = beaten || (j->m_channelWidth < i->m_channelWidth && j->m_dataRate >= i->m_dataRate);
+        }
+      if (!kept && !beaten)
+        {
+          std::cout << "FAIL: " << i->m_channelWidth << " MHz at " << i->m_dataRate / 1000
+                    << " kb/s was dropped but no narrower rate matches it" << std::endl;
+          ok = false;
+        }
+    }
+  std::cout << ladder.m_entries.size () << " of " << all.size () << " rates kept" << std::endl;
+  return ok ? 0 : 1;
+}
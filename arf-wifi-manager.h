@@ -21,8 +21,7 @@
 #ifndef ARF_WIFI_MANAGER_H
 #define ARF_WIFI_MANAGER_H
 
-#include "ns3/traced-value.h"
-#include "wifi-remote-station-manager.h"
+#include "arf-family-wifi-manager.h"
 
 namespace ns3 {
 
@@ -35,17 +34,19 @@ namespace ns3 {
  * LAN for the unlicensed band</i>, by A. Kamerman and L. Monteban. in
  * Bell Lab Technical Journal, pages 118-133, Summer 1997.
  *
- * This implementation differs from the initial description in that it
- * uses a packet-based timer rather than a time-based timer as described
- * in XXX (I cannot find back the original paper which described how
- * the time-based timer could be easily replaced with a packet-based
- * timer.)
+ * By default this implementation differs from the initial description in
+ * that it uses a packet-based timer rather than a time-based timer as
+ * described in XXX (I cannot find back the original paper which described
+ * how the time-based timer could be easily replaced with a packet-based
+ * timer.) The TimeBasedTimer attribute selects the time-based timer of
+ * the original design, which expires after ProbeInterval.
  *
- * This RAA does not support HT, VHT nor HE modes and will error
- * exit if the user tries to configure this RAA with a Wi-Fi MAC
- * that has VhtSupported, HtSupported or HeSupported set.
+ * The state machine is shared with AARF in ArfFamilyWifiManager; ARF
+ * uses fixed thresholds (ArfThresholdPolicy).
+ *
+ * HT, VHT and HE stations are handled by walking their MCS ladder.
  */
-class ArfWifiManager : public WifiRemoteStationManager
+class ArfWifiManager : public ArfFamilyWifiManager<ArfThresholdPolicy>
 {
 public:
   /**
@@ -55,34 +56,6 @@ public:
   static TypeId GetTypeId (void);
   ArfWifiManager ();
   virtual ~ArfWifiManager ();
-
-  // Inherited from WifiRemoteStationManager
-  void SetHtSupported (bool enable);
-  void SetVhtSupported (bool enable);
-  void SetHeSupported (bool enable);
-
-
-private:
-  //overriden from base class
-  WifiRemoteStation * DoCreateStation (void) const;
-  void DoReportRxOk (WifiRemoteStation *station,
-                     double rxSnr, WifiMode txMode);
-  void DoReportRtsFailed (WifiRemoteStation *station);
-  void DoReportDataFailed (WifiRemoteStation *station);
-  void DoReportRtsOk (WifiRemoteStation *station,
-                      double ctsSnr, WifiMode ctsMode, double rtsSnr);
-  void DoReportDataOk (WifiRemoteStation *station,
-                       double ackSnr, WifiMode ackMode, double dataSnr);
-  void DoReportFinalRtsFailed (WifiRemoteStation *station);
-  void DoReportFinalDataFailed (WifiRemoteStation *station);
-  WifiTxVector DoGetDataTxVector (WifiRemoteStation *station);
-  WifiTxVector DoGetRtsTxVector (WifiRemoteStation *station);
-  bool IsLowLatency (void) const;
-
-  uint32_t m_timerThreshold; ///< timer threshold
-  uint32_t m_successThreshold; ///< success threshold
-
-  TracedValue<uint64_t> m_currentRate; //!< Trace rate changes
 };
 
 } //namespace ns3